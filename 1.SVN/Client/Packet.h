@@ -29,13 +29,47 @@ enum class BadAffectType : uint8_t {
 enum class EPacketCGBossDamageRankingSubHeaderType : uint8_t {
     BOSS_DMG_RANKING_RANK_INFO,
     BOSS_DMG_RANKING_DAMAGE_INFO,
+    BOSS_DMG_RANKING_RANK_DELTA,
+    BOSS_DMG_RANKING_GROUP_INFO,
+};
+
+enum class EBossDamageRankingGroupType : uint8_t
+{
+    PARTY,
+    GUILD,
+};
+
+enum class EBossDamageRankingRowField : uint8_t
+{
+    PLAYER = 1 << 0,
+    PERCENT_DAMAGE = 1 << 1,
+    BAD_AFFECT_FLAG = 1 << 2,
 };
 
 struct SPacketGCRankingGeneralInfo
 {
+    uint32_t boss_vid;
+    uint32_t version;
     uint8_t rank_size;
 };
 
+struct SPacketGCRankingDeltaInfo
+{
+    uint32_t boss_vid;
+    uint32_t base_version;
+    uint32_t version;
+    uint8_t rank_size;
+    uint8_t row_count;
+};
+
+// followed by race and name if PLAYER is set, percent_damage if PERCENT_DAMAGE is set
+// and bad_affect_flag if BAD_AFFECT_FLAG is set
+struct SPacketGCBossDamageRankingDeltaRow
+{
+    uint8_t position;
+    uint8_t field_mask;
+};
+
 struct SPacketGCBossDamageRankingInfo
 {
     uint8_t race;
@@ -43,4 +77,32 @@ struct SPacketGCBossDamageRankingInfo
     uint8_t percent_damage;
     uint8_t bad_affect_flag;
 };
+
+struct SPacketGCBossDamageRankingDamageInfo
+{
+    uint16_t rank;
+    uint16_t participant_count;
+    uint8_t percent_damage;
+    uint64_t damage;
+    // damage per second over the last 10 seconds
+    uint32_t dps;
+};
+
+// followed by rank_size SPacketGCBossDamageRankingGroupInfo, highest damage first;
+// always sent with a full ranking, with a delta only if the group rows changed
+struct SPacketGCBossDamageRankingGroupGeneralInfo
+{
+    uint32_t boss_vid;
+    uint8_t group_type;
+    uint8_t rank_size;
+};
+
+// name is the guild name, or the party leader's name; a party whose leader is on another
+// core is named after the member that first brought it into the ranking
+struct SPacketGCBossDamageRankingGroupInfo
+{
+    char name[CHARACTER_NAME_MAX_LEN + 1];
+    uint16_t member_count;
+    uint8_t percent_damage;
+};
 #endif
\ No newline at end of file
@@ -32,6 +32,13 @@ bool CPythonNetworkStream::RecvBossDamageRankingPacket()
         b_ret = bossdamageranking::PythonBossDamageRanking::Instance().recv_boss_ranking_rank_info();
         break;
     case EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_DAMAGE_INFO:
+        b_ret = bossdamageranking::PythonBossDamageRanking::Instance().recv_boss_ranking_damage_info();
+        break;
+    case EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RANK_DELTA:
+        b_ret = bossdamageranking::PythonBossDamageRanking::Instance().recv_boss_ranking_rank_delta();
+        break;
+    case EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_GROUP_INFO:
+        b_ret = bossdamageranking::PythonBossDamageRanking::Instance().recv_boss_ranking_group_info();
         break;
     default:
         TraceError("CPythonNetworkStream::RecvBossDamageRanking - Unknown subheader %d", pack.sub_header);
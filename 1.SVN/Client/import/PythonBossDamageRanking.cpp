@@ -41,7 +41,42 @@ void PythonBossDamageRanking::update_ranking_info(const std::vector<SPacketGCBos
     mp_py_middleware->call_window_func("update_ranking_info", py_dict.build());
 }
 
-bool PythonBossDamageRanking::recv_boss_ranking_rank_info() const
+void PythonBossDamageRanking::update_damage_info(const SPacketGCBossDamageRankingDamageInfo& damage_info) const
+{
+    pythonwrapper::PythonObjectBuilder py_damage_info{pythonwrapper::PythonObjectType::List};
+
+    py_damage_info.add_item(static_cast<unsigned>(damage_info.rank))
+        .add_item(static_cast<unsigned>(damage_info.participant_count))
+        .add_item(static_cast<unsigned>(damage_info.percent_damage))
+        .add_item(static_cast<unsigned long long>(damage_info.damage))
+        .add_item(static_cast<unsigned>(damage_info.dps));
+
+    mp_py_middleware->call_window_func("update_damage_info", py_damage_info.build());
+}
+
+void PythonBossDamageRanking::update_group_ranking_info(
+    const uint8_t group_type, const std::vector<SPacketGCBossDamageRankingGroupInfo>& info_vec) const
+{
+    pythonwrapper::PythonObjectBuilder py_group_list{pythonwrapper::PythonObjectType::List};
+
+    for (const auto& [name, member_count, percent_damage]: info_vec)
+    {
+        pythonwrapper::PythonObjectBuilder py_group_info{pythonwrapper::PythonObjectType::List};
+
+        py_group_info.add_item(name)
+            .add_item(static_cast<unsigned>(member_count))
+            .add_item(static_cast<unsigned>(percent_damage));
+        py_group_list.add_item(py_group_info.build());
+    }
+
+    pythonwrapper::PythonObjectBuilder py_args{pythonwrapper::PythonObjectType::List};
+
+    py_args.add_item(static_cast<unsigned>(group_type)).add_item(py_group_list.build());
+
+    mp_py_middleware->call_window_func("update_group_ranking_info", py_args.build());
+}
+
+bool PythonBossDamageRanking::recv_boss_ranking_rank_info()
 {
     auto& ins{CPythonNetworkStream::Instance()};
 
@@ -60,11 +95,150 @@ bool PythonBossDamageRanking::recv_boss_ranking_rank_info() const
         return false;
     }
 
+    if (m_ranking_tables.size() >= max_ranking_tables && m_ranking_tables.find(subpacket.boss_vid) == m_ranking_tables.end())
+    {
+        m_ranking_tables.clear();
+    }
+
+    auto& ranking_table{m_ranking_tables[subpacket.boss_vid]};
+    ranking_table.version = subpacket.version;
+    ranking_table.info_vec = info_vec;
+
     update_ranking_info(info_vec);
 
     return true;
 }
 
+bool PythonBossDamageRanking::recv_boss_ranking_rank_delta()
+{
+    auto& ins{CPythonNetworkStream::Instance()};
+
+    SPacketGCRankingDeltaInfo subpacket{};
+    if (!ins.Recv(sizeof(SPacketGCRankingDeltaInfo), &subpacket))
+    {
+        return false;
+    }
+
+    // the rows are always read, so the stream stays aligned even if the delta is dropped
+    std::vector<std::pair<SPacketGCBossDamageRankingDeltaRow, SPacketGCBossDamageRankingInfo>> row_vec{};
+    row_vec.reserve(subpacket.row_count);
+
+    for (uint8_t row_index{}; row_index < subpacket.row_count; ++row_index)
+    {
+        SPacketGCBossDamageRankingDeltaRow row{};
+        SPacketGCBossDamageRankingInfo info{};
+
+        bool b_recv{ins.Recv(sizeof(row), &row)};
+
+        if (b_recv && 0 != (row.field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::PLAYER)))
+        {
+            b_recv = ins.Recv(sizeof(info.race), &info.race) && ins.Recv(sizeof(info.name), info.name);
+        }
+
+        if (b_recv && 0 != (row.field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::PERCENT_DAMAGE)))
+        {
+            b_recv = ins.Recv(sizeof(info.percent_damage), &info.percent_damage);
+        }
+
+        if (b_recv && 0 != (row.field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::BAD_AFFECT_FLAG)))
+        {
+            b_recv = ins.Recv(sizeof(info.bad_affect_flag), &info.bad_affect_flag);
+        }
+
+        if (!b_recv)
+        {
+            TraceError("SPacketGCBossDamageRankingDeltaRow Recv error");
+
+            return false;
+        }
+
+        row_vec.emplace_back(row, info);
+    }
+
+    const auto table_iter{m_ranking_tables.find(subpacket.boss_vid)};
+
+    if (table_iter == m_ranking_tables.end() || table_iter->second.version != subpacket.base_version)
+    {
+        // the server sends a full ranking to players that missed a version, so this only skips one update
+        TraceError("PythonBossDamageRanking::recv_boss_ranking_rank_delta - version gap for boss %u (%u)",
+            subpacket.boss_vid,
+            subpacket.base_version);
+
+        return true;
+    }
+
+    auto& ranking_table{table_iter->second};
+    ranking_table.info_vec.resize(subpacket.rank_size);
+
+    for (const auto& [row, info]: row_vec)
+    {
+        if (row.position >= ranking_table.info_vec.size()) { continue; }
+
+        auto& cached_info{ranking_table.info_vec[row.position]};
+
+        if (0 != (row.field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::PLAYER)))
+        {
+            cached_info.race = info.race;
+            std::memcpy(cached_info.name, info.name, sizeof(cached_info.name));
+        }
+
+        if (0 != (row.field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::PERCENT_DAMAGE)))
+        {
+            cached_info.percent_damage = info.percent_damage;
+        }
+
+        if (0 != (row.field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::BAD_AFFECT_FLAG)))
+        {
+            cached_info.bad_affect_flag = info.bad_affect_flag;
+        }
+    }
+
+    ranking_table.version = subpacket.version;
+
+    update_ranking_info(ranking_table.info_vec);
+
+    return true;
+}
+
+bool PythonBossDamageRanking::recv_boss_ranking_damage_info() const
+{
+    SPacketGCBossDamageRankingDamageInfo damage_info{};
+    if (!CPythonNetworkStream::Instance().Recv(sizeof(SPacketGCBossDamageRankingDamageInfo), &damage_info))
+    {
+        TraceError("SPacketGCBossDamageRankingDamageInfo Recv error");
+
+        return false;
+    }
+
+    update_damage_info(damage_info);
+
+    return true;
+}
+
+bool PythonBossDamageRanking::recv_boss_ranking_group_info() const
+{
+    auto& ins{CPythonNetworkStream::Instance()};
+
+    SPacketGCBossDamageRankingGroupGeneralInfo subpacket{};
+    if (!ins.Recv(sizeof(SPacketGCBossDamageRankingGroupGeneralInfo), &subpacket))
+    {
+        return false;
+    }
+
+    std::vector<SPacketGCBossDamageRankingGroupInfo> info_vec{subpacket.rank_size};
+
+    if (!ins.Recv(sizeof(SPacketGCBossDamageRankingGroupInfo) * subpacket.rank_size, info_vec.data()))
+    {
+        TraceError("SPacketGCBossDamageRankingGroupInfo Recv error");
+
+        return false;
+    }
+
+    update_group_ranking_info(subpacket.group_type, info_vec);
+
+    return true;
+}
+
 namespace py_funcs {
 
 PyObject* set_ui_window([[maybe_unused]] PyObject* po_self, PyObject* po_args)
@@ -6,6 +6,15 @@
 
 namespace bossdamageranking {
 class PythonBossDamageRanking final : public CSingleton<PythonBossDamageRanking> {
+    /**
+     * @brief Ranking rows of a boss as last received from the server
+     */
+    struct RankingTable
+    {
+        uint32_t version{};
+        std::vector<SPacketGCBossDamageRankingInfo> info_vec{};
+    };
+
 public:
 
     PythonBossDamageRanking();
@@ -18,8 +27,29 @@ public:
 
     void update_ranking_info(const std::vector<SPacketGCBossDamageRankingInfo>& info_vec) const;
 
-    [[nodiscard]] bool recv_boss_ranking_rank_info() const;
+    void update_damage_info(const SPacketGCBossDamageRankingDamageInfo& damage_info) const;
+
+    void update_group_ranking_info(
+        uint8_t group_type, const std::vector<SPacketGCBossDamageRankingGroupInfo>& info_vec) const;
+
+    [[nodiscard]] bool recv_boss_ranking_rank_info();
+
+    [[nodiscard]] bool recv_boss_ranking_rank_delta();
+
+    [[nodiscard]] bool recv_boss_ranking_damage_info() const;
+
+    [[nodiscard]] bool recv_boss_ranking_group_info() const;
 private:
+    /**
+     * @brief Cached ranking tables, keyed by boss VID
+     */
+    std::unordered_map<uint32_t, RankingTable> m_ranking_tables{};
+
+    /**
+     * @brief Number of boss rankings kept before the cache is reset
+     */
+    static constexpr size_t max_ranking_tables{8U};
+
     /**
      * @brief Middleware for abstracting Python calls
      */
@@ -0,0 +1,473 @@
+/*
+ * ? Author: LWT
+ * * Description: Microbenchmark of the boss damage ranking hit path.
+ *
+ * Builds against the stand-in game headers in stub/, see the Makefile.
+ * Hardware counters come from perf_event_open; where the kernel or the VM
+ * does not expose them only the timings are printed.
+ *
+ *   ./bench_boss_ranking                              the built-in scenarios
+ *   ./bench_boss_ranking bosses participants hits [dot_percent] [worker_thread]
+ */
+#include "stdafx.h"
+
+#include <new>
+#include <random>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bossdamagerankingmanager.hpp"
+#include "char_manager.h"
+#include "db.h"
+
+namespace
+{
+
+/**
+ * @brief Heap allocations made so far, counted by the replaced operator new on every thread
+ */
+std::atomic<uint64_t> allocation_count{};
+
+} // namespace
+
+void* operator new(const size_t size)
+{
+    allocation_count.fetch_add(1U, std::memory_order_relaxed);
+
+    if (auto* const p_memory{std::malloc(0U != size ? size : 1U)}; nullptr != p_memory)
+    {
+        return p_memory;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p_memory) noexcept
+{
+    std::free(p_memory);
+}
+
+void operator delete(void* p_memory, size_t) noexcept
+{
+    std::free(p_memory);
+}
+
+namespace
+{
+
+/**
+ * @brief One hardware event counted in user space for the calling thread
+ */
+class PerfCounter
+{
+public:
+    PerfCounter(const uint32_t type, const uint64_t config) noexcept
+    {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    ~PerfCounter()
+    {
+#if defined(__linux__)
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+#endif
+    }
+
+    [[nodiscard]] bool is_available() const noexcept { return m_fd >= 0; }
+
+    void start() noexcept
+    {
+#if defined(__linux__)
+        if (is_available())
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    [[nodiscard]] uint64_t stop() noexcept
+    {
+        uint64_t count{};
+#if defined(__linux__)
+        if (is_available())
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            if (sizeof(count) != read(m_fd, &count, sizeof(count)))
+            {
+                count = 0U;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int m_fd{-1};
+};
+
+#if defined(__linux__)
+constexpr uint64_t l1d_read_miss_config{PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8U) |
+                                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U)};
+#endif
+
+/**
+ * @brief Cache misses and time of a measured section
+ */
+class Measurement
+{
+public:
+    Measurement()
+#if defined(__linux__)
+        : m_llc_misses{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+          m_l1d_misses{PERF_TYPE_HW_CACHE, l1d_read_miss_config}
+#else
+        : m_llc_misses{0U, 0U},
+          m_l1d_misses{0U, 0U}
+#endif
+    {
+    }
+
+    void start()
+    {
+        m_llc_misses.start();
+        m_l1d_misses.start();
+        m_start_time = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief Stop the section and print its cost per operation
+     *
+     * @param p_name The section name
+     * @param operations The operations run in the section
+     * @param excluded_time Time spent in the section on something else, left out of ns/op
+     */
+    void stop_and_print(const char* p_name, const uint64_t operations, const std::chrono::nanoseconds excluded_time)
+    {
+        const auto elapsed{std::chrono::steady_clock::now() - m_start_time - excluded_time};
+        const auto llc_misses{m_llc_misses.stop()};
+        const auto l1d_misses{m_l1d_misses.stop()};
+
+        const auto ops{static_cast<double>(std::max<uint64_t>(operations, 1U))};
+        const auto ns{std::chrono::duration<double, std::nano>(elapsed).count()};
+
+        std::printf("  %-16s %12llu ops %9.1f ns/op", p_name, static_cast<unsigned long long>(operations), ns / ops);
+
+        if (m_l1d_misses.is_available())
+        {
+            std::printf(" %8.3f L1d-miss/op", static_cast<double>(l1d_misses) / ops);
+        }
+
+        if (m_llc_misses.is_available())
+        {
+            std::printf(" %8.3f cache-miss/op", static_cast<double>(llc_misses) / ops);
+        }
+
+        if (!m_l1d_misses.is_available() && !m_llc_misses.is_available())
+        {
+            std::printf("  (hardware counters unavailable)");
+        }
+
+        std::printf("\n");
+    }
+
+private:
+    PerfCounter m_llc_misses;
+    PerfCounter m_l1d_misses;
+    std::chrono::steady_clock::time_point m_start_time{};
+};
+
+/**
+ * @brief One measured fight setup
+ */
+struct Scenario
+{
+    const char* p_name{};
+    uint32_t boss_count{};
+    uint32_t participants_per_boss{};
+    uint64_t hit_count{};
+
+    /**
+     * @brief Share of the hits that are poison ticks, which also set a bad affect flag
+     */
+    uint32_t dot_percent{};
+
+    /**
+     * @brief Whether the rankings run on the worker thread; ns/op is then the game thread's share
+     */
+    bool worker_thread{};
+};
+
+/**
+ * @brief Hits per attacker and second, turns the hits into game pulses
+ */
+constexpr uint32_t attacks_per_sec{2U};
+
+constexpr std::array<Scenario, 4> default_scenarios{{
+    {"world boss: 1 boss x 500 attackers", 1U, 500U, 2000000U, 0U, false},
+    {"field bosses: 50 bosses x 20 attackers", 50U, 20U, 2000000U, 0U, false},
+    {"dot heavy: 8 bosses x 100 attackers, 60% DoT", 8U, 100U, 2000000U, 60U, false},
+    {"world boss on the worker thread: 1 boss x 500 attackers", 1U, 500U, 2000000U, 0U, true},
+}};
+
+constexpr uint32_t boss_vnum{2493U};
+constexpr uint32_t first_boss_vid{100000U};
+
+/**
+ * @brief Players per party and per guild, so every hit also feeds the group rankings
+ */
+constexpr size_t party_size{8U};
+constexpr size_t guild_size{50U};
+
+/**
+ * @brief Run one scenario on a fresh manager and print its numbers
+ *
+ * @param scenario The scenario
+ */
+void run_scenario(const Scenario& scenario)
+{
+    CHARACTER_MANAGER character_manager{};
+    bossdamageranking::CBossDamageRankingManager ranking_manager{};
+
+    ranking_manager.set_worker_thread(scenario.worker_thread);
+    ranking_manager.initialize();
+
+    std::vector<CHARACTER> boss_vec(scenario.boss_count);
+
+    for (uint32_t boss_index{}; boss_index < scenario.boss_count; ++boss_index)
+    {
+        auto& boss{boss_vec[boss_index]};
+        boss.m_race = boss_vnum;
+        boss.m_vid = first_boss_vid + boss_index;
+
+        bossdamageranking::BossDamageRankingBossInfo boss_info{};
+        boss_info.mob_vnum = boss.GetRaceNum();
+        boss_info.mob_vid = boss.GetVID();
+        boss_info.max_hp = 50000000U;
+
+        boss.SetBossDamageRankingHandle(ranking_manager.add_boss_to_list(boss_info));
+        character_manager.Register(&boss);
+    }
+
+    const auto player_count{static_cast<size_t>(scenario.boss_count) * scenario.participants_per_boss};
+
+    std::vector<DESC> desc_vec(player_count);
+    std::vector<CHARACTER> player_vec(player_count);
+    std::vector<CParty> party_vec((player_count + party_size - 1U) / party_size);
+    std::vector<CGuild> guild_vec((player_count + guild_size - 1U) / guild_size);
+
+    for (size_t player_index{}; player_index < player_count; ++player_index)
+    {
+        auto& player{player_vec[player_index]};
+        player.m_player_id = static_cast<DWORD>(player_index + 1U);
+        player.m_vid = static_cast<DWORD>(first_boss_vid + scenario.boss_count + player_index);
+        player.m_race = static_cast<DWORD>(player_index % 8U);
+        player.m_name = "player" + std::to_string(player.m_player_id);
+        player.mp_desc = &desc_vec[player_index];
+
+        // the first member of a party leads it
+        auto& party{party_vec[player_index / party_size]};
+
+        if (0U == player_index % party_size)
+        {
+            party.m_party_id = static_cast<uint32_t>(player_index / party_size + 1U);
+            party.m_leader_pid = player.m_player_id;
+            party.mp_leader = &player;
+        }
+
+        auto& guild{guild_vec[player_index / guild_size]};
+        guild.m_id = static_cast<DWORD>(player_index / guild_size + 1U);
+        guild.m_name = "guild" + std::to_string(guild.m_id);
+
+        player.mp_party = &party;
+        player.mp_guild = &guild;
+
+        character_manager.Register(&player);
+    }
+
+    // every participant joins its boss before the measured hits
+    for (size_t player_index{}; player_index < player_count; ++player_index)
+    {
+        const auto& boss{boss_vec[player_index / scenario.participants_per_boss]};
+        ranking_manager.damage_process(&player_vec[player_index], boss.GetBossDamageRankingHandle(), 1U);
+    }
+
+    struct Hit
+    {
+        uint32_t boss_index;
+        uint32_t player_index;
+        uint32_t damage;
+        bool is_dot;
+    };
+
+    std::mt19937 random_engine{12345U};
+    std::uniform_int_distribution<uint32_t> boss_dist{0U, scenario.boss_count - 1U};
+    std::uniform_int_distribution<uint32_t> participant_dist{0U, scenario.participants_per_boss - 1U};
+    std::uniform_int_distribution<uint32_t> damage_dist{100U, 5000U};
+    std::uniform_int_distribution<uint32_t> percent_dist{0U, 99U};
+
+    std::vector<Hit> hit_vec(scenario.hit_count);
+
+    for (auto& hit : hit_vec)
+    {
+        hit.boss_index = boss_dist(random_engine);
+        hit.player_index = hit.boss_index * scenario.participants_per_boss + participant_dist(random_engine);
+        hit.is_dot = percent_dist(random_engine) < scenario.dot_percent;
+        hit.damage = hit.is_dot ? damage_dist(random_engine) / 10U : damage_dist(random_engine);
+    }
+
+    const auto hits_per_pulse{
+        std::max<uint64_t>(player_count * attacks_per_sec / static_cast<uint64_t>(passes_per_sec), 1U)};
+    const auto pulse_time{static_cast<DWORD>(1000 / passes_per_sec)};
+
+    const auto count_sent_bytes{[&desc_vec]
+        {
+            uint64_t sent_bytes{};
+
+            for (const auto& desc : desc_vec)
+            {
+                sent_bytes += desc.m_sent_bytes;
+            }
+
+            return sent_bytes;
+        }};
+
+    std::printf("%s, %llu hits, %llu hits per pulse\n",
+        scenario.p_name,
+        static_cast<unsigned long long>(scenario.hit_count),
+        static_cast<unsigned long long>(hits_per_pulse));
+
+    // the joins queued on the worker are not part of the measured hits
+    ranking_manager.wait_for_worker();
+
+    const auto broadcast_stats_before{ranking_manager.get_broadcast_stats()};
+    const auto sent_bytes_before{count_sent_bytes()};
+    const auto allocations_before{allocation_count.load()};
+
+    std::chrono::nanoseconds pulse_elapsed{};
+    int pulse{};
+
+    Measurement measurement{};
+
+    measurement.start();
+
+    for (size_t hit_index{}; hit_index < hit_vec.size(); ++hit_index)
+    {
+        const auto& hit{hit_vec[hit_index]};
+        auto* const p_player{&player_vec[hit.player_index]};
+        const auto& boss_handle{boss_vec[hit.boss_index].GetBossDamageRankingHandle()};
+
+        ranking_manager.damage_process(p_player, boss_handle, hit.damage);
+
+        if (hit.is_dot)
+        {
+            ranking_manager.set_bad_affect(boss_handle, p_player->GetPlayerID(), bossdamageranking::BadAffectType::POISON);
+        }
+
+        if (0U == (hit_index + 1U) % hits_per_pulse)
+        {
+            const auto pulse_start{std::chrono::steady_clock::now()};
+
+            bench_time_ms += pulse_time;
+            ranking_manager.update(++pulse);
+
+            pulse_elapsed += std::chrono::steady_clock::now() - pulse_start;
+        }
+    }
+
+    measurement.stop_and_print("damage_process", scenario.hit_count, pulse_elapsed);
+
+    // the rankings the worker still holds count too; the hits are replayed far faster than real
+    // time, so a worker that falls behind merges the pulses waiting in line and sends fewer rankings
+    ranking_manager.wait_for_worker();
+
+    const auto& broadcast_stats{ranking_manager.get_broadcast_stats()};
+    const auto broadcasts{broadcast_stats.broadcasts - broadcast_stats_before.broadcasts};
+    const auto recipients{broadcast_stats.recipients - broadcast_stats_before.recipients};
+    const auto sent_bytes{count_sent_bytes() - sent_bytes_before};
+    const auto allocations{allocation_count - allocations_before};
+
+    const auto hits{static_cast<double>(std::max<uint64_t>(scenario.hit_count, 1U))};
+    const auto simulated_sec{std::max(static_cast<double>(pulse) / passes_per_sec, 1.0 / passes_per_sec)};
+
+    std::printf("  %-16s %12d pulses %8.1f us/pulse\n",
+        "update",
+        pulse,
+        std::chrono::duration<double, std::micro>(pulse_elapsed).count() / std::max(pulse, 1));
+    std::printf("  %-16s %12llu total %9.1f /s %8.1f recipients each\n",
+        "broadcasts",
+        static_cast<unsigned long long>(broadcasts),
+        static_cast<double>(broadcasts) / simulated_sec,
+        static_cast<double>(recipients) / static_cast<double>(std::max<uint64_t>(broadcasts, 1U)));
+    std::printf("  %-16s %12llu total %9.1f /hit\n",
+        "bytes sent",
+        static_cast<unsigned long long>(sent_bytes),
+        static_cast<double>(sent_bytes) / hits);
+    std::printf("  %-16s %12llu total %9.3f /hit\n",
+        "allocations",
+        static_cast<unsigned long long>(allocations),
+        static_cast<double>(allocations) / hits);
+
+    if (scenario.worker_thread)
+    {
+        for (const auto& line : ranking_manager.create_stats_report())
+        {
+            if (0 == line.compare(0, 7U, "worker:")) { std::printf("  %s\n", line.c_str()); }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    DBManager db_manager{};
+    db_manager.m_boss_vnum_vec.emplace_back(boss_vnum);
+
+    if (argc > 1)
+    {
+        Scenario scenario{"custom", 1U, 1U, 1U, 0U, false};
+
+        str_to_number(scenario.boss_count, argv[1]);
+        if (argc > 2) { str_to_number(scenario.participants_per_boss, argv[2]); }
+        if (argc > 3) { str_to_number(scenario.hit_count, argv[3]); }
+        if (argc > 4) { str_to_number(scenario.dot_percent, argv[4]); }
+        if (argc > 5) { scenario.worker_thread = 0 != std::atoi(argv[5]); }
+
+        scenario.boss_count = std::max(scenario.boss_count, 1U);
+        scenario.participants_per_boss = std::max(scenario.participants_per_boss, 1U);
+
+        run_scenario(scenario);
+
+        return 0;
+    }
+
+    for (const auto& scenario : default_scenarios)
+    {
+        run_scenario(scenario);
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+/*
+ * Stand-in for common/tables.h, only what the boss damage ranking needs.
+ */
+#ifndef BENCH_TABLES_H
+#define BENCH_TABLES_H
+
+#include <cstdint>
+
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+
+enum
+{
+    CHARACTER_NAME_MAX_LEN = 24,
+};
+
+struct TMobTable
+{
+    DWORD dwVnum;
+    DWORD dwMaxHP;
+};
+
+#endif // BENCH_TABLES_H
@@ -0,0 +1,39 @@
+/*
+ * Stand-in for buffer_manager.h: TEMP_BUFFER over a growable byte vector.
+ */
+#ifndef BENCH_BUFFER_MANAGER_H
+#define BENCH_BUFFER_MANAGER_H
+
+#include <type_traits>
+
+class TEMP_BUFFER
+{
+public:
+    void write(const void* p_data, int size)
+    {
+        const auto* const p_bytes{static_cast<const char*>(p_data)};
+        m_buffer.insert(m_buffer.end(), p_bytes, p_bytes + size);
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        if constexpr (requires { value.data(); value.size(); })
+        {
+            write(value.data(), static_cast<int>(value.size() * sizeof(*value.data())));
+        }
+        else
+        {
+            write(&value, static_cast<int>(sizeof(T)));
+        }
+    }
+
+    const void* read_peek() const { return m_buffer.data(); }
+    int size() const { return static_cast<int>(m_buffer.size()); }
+    void reset() { m_buffer.clear(); }
+
+private:
+    std::vector<char> m_buffer{};
+};
+
+#endif // BENCH_BUFFER_MANAGER_H
@@ -0,0 +1,55 @@
+/*
+ * Stand-in for char.h: a player or mob with the accessors the ranking uses.
+ */
+#ifndef BENCH_CHAR_H
+#define BENCH_CHAR_H
+
+#include "bossdamagerankinghandle.hpp"
+#include "desc.h"
+#include "guild.h"
+#include "party.h"
+
+class CHARACTER
+{
+public:
+    DWORD GetPlayerID() const { return m_player_id; }
+    DWORD GetRaceNum() const { return m_race; }
+    const char* GetName() const { return m_name.c_str(); }
+    LPDESC GetDesc() const { return mp_desc; }
+    DWORD GetVID() const { return m_vid; }
+    long GetMapIndex() const { return m_map_index; }
+    bool IsPC() const { return 0U != m_player_id; }
+    bool IsDead() const { return m_dead; }
+    LPPARTY GetParty() const { return mp_party; }
+    CGuild* GetGuild() const { return mp_guild; }
+
+    void SetBossDamageRankingHandle(const bossdamageranking::BossDamageRankingHandle& handle)
+    {
+        m_bossDamageRankingHandle = handle;
+    }
+
+    const bossdamageranking::BossDamageRankingHandle& GetBossDamageRankingHandle() const
+    {
+        return m_bossDamageRankingHandle;
+    }
+
+    void SetBossDamageRankingRecipientSlot(const uint32_t recipient_slot) { m_bossDamageRankingRecipientSlot = recipient_slot; }
+    uint32_t GetBossDamageRankingRecipientSlot() const { return m_bossDamageRankingRecipientSlot; }
+    void SetBossDamageRankingGroupKey(const uint64_t group_key) { m_bossDamageRankingGroupKey = group_key; }
+    uint64_t GetBossDamageRankingGroupKey() const { return m_bossDamageRankingGroupKey; }
+
+    DWORD m_player_id{};
+    DWORD m_race{};
+    std::string m_name{};
+    LPDESC mp_desc{};
+    DWORD m_vid{};
+    long m_map_index{};
+    bool m_dead{};
+    LPPARTY mp_party{};
+    CGuild* mp_guild{};
+    bossdamageranking::BossDamageRankingHandle m_bossDamageRankingHandle{};
+    uint32_t m_bossDamageRankingRecipientSlot{bossdamageranking::no_recipient_slot};
+    uint64_t m_bossDamageRankingGroupKey{};
+};
+
+#endif // BENCH_CHAR_H
@@ -0,0 +1,39 @@
+/*
+ * Stand-in for char_manager.h: lookups by PID and VID over the bench characters.
+ */
+#ifndef BENCH_CHAR_MANAGER_H
+#define BENCH_CHAR_MANAGER_H
+
+#include "char.h"
+
+class CHARACTER_MANAGER : public singleton<CHARACTER_MANAGER>
+{
+public:
+    LPCHARACTER FindByPID(DWORD player_id)
+    {
+        const auto iter{m_pc_map.find(player_id)};
+        return m_pc_map.end() == iter ? nullptr : iter->second;
+    }
+
+    LPCHARACTER Find(DWORD vid)
+    {
+        const auto iter{m_vid_map.find(vid)};
+        return m_vid_map.end() == iter ? nullptr : iter->second;
+    }
+
+    void Register(LPCHARACTER p_character)
+    {
+        if (p_character->IsPC())
+        {
+            m_pc_map[p_character->GetPlayerID()] = p_character;
+        }
+
+        m_vid_map[p_character->GetVID()] = p_character;
+    }
+
+private:
+    std::unordered_map<DWORD, LPCHARACTER> m_pc_map{};
+    std::unordered_map<DWORD, LPCHARACTER> m_vid_map{};
+};
+
+#endif // BENCH_CHAR_MANAGER_H
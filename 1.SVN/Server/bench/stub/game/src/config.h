@@ -0,0 +1,9 @@
+/*
+ * Stand-in for config.h: the settings of the core the plugin reads.
+ */
+#ifndef BENCH_CONFIG_H
+#define BENCH_CONFIG_H
+
+inline BYTE g_bChannel{1};
+
+#endif // BENCH_CONFIG_H
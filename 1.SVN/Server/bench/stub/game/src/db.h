@@ -0,0 +1,79 @@
+/*
+ * Stand-in for db.h: DirectQuery and FuncQuery answer with the vnums the bench registered.
+ */
+#ifndef BENCH_DB_H
+#define BENCH_DB_H
+
+struct MYSQL_RES
+{
+    std::vector<std::string> values{};
+    std::vector<char*> row{};
+    size_t position{};
+};
+
+typedef char** MYSQL_ROW;
+
+inline MYSQL_ROW mysql_fetch_row(MYSQL_RES* p_result)
+{
+    if (p_result->position >= p_result->values.size())
+    {
+        return nullptr;
+    }
+
+    // boss_vnum, then the policy columns at their table defaults
+    static char max_participants[]{"0"};
+    static char enabled[]{"1"};
+
+    p_result->row = {p_result->values[p_result->position++].data(), nullptr, nullptr, max_participants, enabled, enabled};
+    return p_result->row.data();
+}
+
+struct SQLResult
+{
+    MYSQL_RES* pSQLResult{};
+    uint32_t uiNumRows{};
+    uint32_t uiAffectedRows{};
+};
+
+class SQLMsg
+{
+public:
+    SQLResult* Get() { return &m_result; }
+
+    uint32_t uiSQLErrno{};
+    SQLResult m_result{};
+    MYSQL_RES m_rows{};
+};
+
+class DBManager : public singleton<DBManager>
+{
+public:
+    SQLMsg* DirectQuery(const char*, ...)
+    {
+        auto* p_msg{new SQLMsg};
+
+        for (const auto vnum : m_boss_vnum_vec)
+        {
+            p_msg->m_rows.values.emplace_back(std::to_string(vnum));
+        }
+
+        p_msg->m_result.pSQLResult = &p_msg->m_rows;
+        p_msg->m_result.uiNumRows = static_cast<uint32_t>(m_boss_vnum_vec.size());
+
+        return p_msg;
+    }
+
+    void Query(const char*, ...) { ++m_query_count; }
+
+    // the stand-in has no DB thread, the result comes back right away
+    void FuncQuery(std::function<void(SQLMsg*)> func, const char* query, ...)
+    {
+        const std::unique_ptr<SQLMsg> msg(DirectQuery(query));
+        func(msg.get());
+    }
+
+    std::vector<uint32_t> m_boss_vnum_vec{};
+    uint64_t m_query_count{};
+};
+
+#endif // BENCH_DB_H
@@ -0,0 +1,16 @@
+/*
+ * Stand-in for desc.h: counts the bytes a client would be sent.
+ */
+#ifndef BENCH_DESC_H
+#define BENCH_DESC_H
+
+class DESC
+{
+public:
+    void Packet(const void*, int size) { m_sent_bytes += static_cast<uint64_t>(size); }
+    void BufferedPacket(const void*, int size) { m_sent_bytes += static_cast<uint64_t>(size); }
+
+    uint64_t m_sent_bytes{};
+};
+
+#endif // BENCH_DESC_H
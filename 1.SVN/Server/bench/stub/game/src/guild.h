@@ -0,0 +1,17 @@
+/*
+ * Stand-in for guild.h: a guild ID and name.
+ */
+#ifndef BENCH_GUILD_H
+#define BENCH_GUILD_H
+
+class CGuild
+{
+public:
+    DWORD GetID() const { return m_id; }
+    const char* GetName() const { return m_name.c_str(); }
+
+    DWORD m_id{};
+    std::string m_name{};
+};
+
+#endif // BENCH_GUILD_H
@@ -0,0 +1,6 @@
+/*
+ * Stand-in for mob_manager.h, unused by the bench.
+ */
+#ifndef BENCH_MOB_MANAGER_H
+#define BENCH_MOB_MANAGER_H
+#endif // BENCH_MOB_MANAGER_H
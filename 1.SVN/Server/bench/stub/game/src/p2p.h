@@ -0,0 +1,15 @@
+/*
+ * Stand-in for p2p.h: peer traffic is dropped.
+ */
+#ifndef BENCH_P2P_H
+#define BENCH_P2P_H
+
+#include "desc.h"
+
+class P2P_MANAGER : public singleton<P2P_MANAGER>
+{
+public:
+    void Send(const void*, int, LPDESC = nullptr) {}
+};
+
+#endif // BENCH_P2P_H
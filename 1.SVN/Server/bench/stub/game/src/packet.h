@@ -0,0 +1,18 @@
+/*
+ * Stand-in for packet.h: the plugin's packet definitions are cut out of
+ * game/packet.h by the bench Makefile, so they never drift from the real ones.
+ */
+#ifndef BENCH_PACKET_H
+#define BENCH_PACKET_H
+
+enum
+{
+    HEADER_GC_BOSS_DMG_RANKING = 241,
+    HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING = 30,
+};
+
+#pragma pack(1)
+#include "packet_plugin.inc"
+#pragma pack()
+
+#endif // BENCH_PACKET_H
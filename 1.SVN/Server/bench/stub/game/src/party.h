@@ -0,0 +1,21 @@
+/*
+ * Stand-in for party.h: a party with a leader and a ranking ID.
+ */
+#ifndef BENCH_PARTY_H
+#define BENCH_PARTY_H
+
+class CParty
+{
+public:
+    DWORD GetLeaderPID() const { return m_leader_pid; }
+    LPCHARACTER GetLeaderCharacter() const { return mp_leader; }
+    uint32_t GetBossDamageRankingPartyID() const { return m_party_id; }
+
+    uint32_t m_party_id{};
+    DWORD m_leader_pid{};
+    LPCHARACTER mp_leader{};
+};
+
+typedef CParty* LPPARTY;
+
+#endif // BENCH_PARTY_H
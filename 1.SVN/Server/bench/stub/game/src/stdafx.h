@@ -0,0 +1,76 @@
+/*
+ * Stand-in for the game stdafx.h: the standard headers and core helpers the
+ * boss damage ranking sources expect to be already included.
+ */
+#ifndef BENCH_STDAFX_H
+#define BENCH_STDAFX_H
+
+#define BOSS_DAMAGE_RANKING_PLUGIN
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../../common/tables.h"
+
+template <typename T>
+class singleton
+{
+public:
+    singleton() { ms_singleton = static_cast<T*>(this); }
+    static T& instance() { return *ms_singleton; }
+    static T& Instance() { return *ms_singleton; }
+
+private:
+    static inline T* ms_singleton{};
+};
+
+#define sys_err(...) (std::fprintf(stderr, __VA_ARGS__), std::fputc('\n', stderr))
+#define sys_log(level, ...) ((void)(level), (void)sizeof(std::printf(__VA_ARGS__)))
+
+template <typename T>
+inline bool str_to_number(T& out, const char* in)
+{
+    out = static_cast<T>(std::strtoull(in, nullptr, 10));
+    return true;
+}
+
+// the bench drives the clock one pulse at a time, so throttling does not depend on the host speed;
+// only the game thread reads it, the ranking worker gets the time with its events
+inline DWORD bench_time_ms{};
+
+inline DWORD get_dword_time()
+{
+    return bench_time_ms;
+}
+
+inline int passes_per_sec{25};
+
+#define PASSES_PER_SEC(sec) ((sec) * passes_per_sec)
+
+inline int get_global_time()
+{
+    return static_cast<int>(get_dword_time() / 1000U);
+}
+
+class CHARACTER;
+typedef CHARACTER* LPCHARACTER;
+class DESC;
+typedef DESC* LPDESC;
+
+#endif // BENCH_STDAFX_H
@@ -6,6 +6,37 @@
 
 // find
 
+void CHARACTER::Initialize()
+{
+    CEntity::Initialize(ENTITY_CHARACTER);
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+    m_bossDamageRankingHandle = {};
+    m_bossDamageRankingRecipientSlot = bossdamageranking::no_recipient_slot;
+    m_bossDamageRankingGroupKey = 0;
+#endif
+
+// find
+
+void CHARACTER::Destroy()
+{
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+    if (IsPC()) { bossdamageranking::boss_dmg_ranking_manager().on_character_destroy(this); }
+    else if (const auto& boss_handle{GetBossDamageRankingHandle()}; boss_handle.is_assigned())
+    {
+        // despawn, GM purge or map teardown: the boss leaves the registry with its mob
+        bossdamageranking::boss_dmg_ranking_manager().erase_boss_from_list(
+            boss_handle, bossdamageranking::EBossDamageRankingFightEnd::DESPAWNED);
+    }
+#endif
+
+// find
+
 void CHARACTER::StartRecoveryEvent()
 {
     if (m_pkRecoveryEvent) return;
@@ -18,8 +49,36 @@ void CHARACTER::StartRecoveryEvent()
 
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
     if (auto& boss_dmg_mng{bossdamageranking::boss_dmg_ranking_manager()};
-        !IsPC() && boss_dmg_mng.is_boss_in_ranking(GetRaceNum()))
+        !IsPC() && boss_dmg_mng.is_boss_tracked(GetBossDamageRankingHandle()))
     {
         return;
     }
 #endif
+
+// find
+
+void CHARACTER::SetParty(LPPARTY pkParty)
+{
+    ...
+    m_pkParty = pkParty;
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+    // joins, leaves and disbands move the member in its boss rankings right away
+    bossdamageranking::boss_dmg_ranking_manager().on_group_changed(this);
+#endif
+
+// find
+
+void CHARACTER::SetGuild(CGuild* pGuild)
+{
+    if (m_pGuild != pGuild)
+    {
+        m_pGuild = pGuild;
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+        bossdamageranking::boss_dmg_ranking_manager().on_group_changed(this);
+#endif
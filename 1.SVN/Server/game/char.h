@@ -0,0 +1,55 @@
+// add includes
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+#include "bossdamagerankinghandle.hpp"
+#endif
+
+// find
+
+  public:
+    CHARACTER();
+    virtual ~CHARACTER();
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+  public:
+    void SetBossDamageRankingHandle(const bossdamageranking::BossDamageRankingHandle& handle)
+    {
+        m_bossDamageRankingHandle = handle;
+    }
+
+    const bossdamageranking::BossDamageRankingHandle& GetBossDamageRankingHandle() const
+    {
+        return m_bossDamageRankingHandle;
+    }
+
+    void SetBossDamageRankingRecipientSlot(const uint32_t recipientSlot)
+    {
+        m_bossDamageRankingRecipientSlot = recipientSlot;
+    }
+
+    uint32_t GetBossDamageRankingRecipientSlot() const
+    {
+        return m_bossDamageRankingRecipientSlot;
+    }
+
+    void SetBossDamageRankingGroupKey(const uint64_t groupKey)
+    {
+        m_bossDamageRankingGroupKey = groupKey;
+    }
+
+    uint64_t GetBossDamageRankingGroupKey() const
+    {
+        return m_bossDamageRankingGroupKey;
+    }
+
+  private:
+    bossdamageranking::BossDamageRankingHandle m_bossDamageRankingHandle{};
+    // slot in the ranking manager's recipient table once the profile was queued for the worker
+    uint32_t m_bossDamageRankingRecipientSlot{bossdamageranking::no_recipient_slot};
+    // party and guild sent with the queued profile
+    uint64_t m_bossDamageRankingGroupKey{};
+
+  public:
+#endif
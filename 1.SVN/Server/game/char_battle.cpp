@@ -23,9 +23,9 @@
 // add below
 
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
-        if (const bool check_boss_and_map{!IsPC() && pkKiller->GetMapIndex() < 1000}; check_boss_and_map)
+        if (const auto& boss_handle{GetBossDamageRankingHandle()}; boss_handle.is_assigned())
         {
-            bossdamageranking::boss_dmg_ranking_manager().erase_boss_from_list({GetRaceNum(), static_cast<DWORD>(GetVID())});
+            bossdamageranking::boss_dmg_ranking_manager().erase_boss_from_list(boss_handle);
         }
 #endif
 
@@ -38,12 +38,9 @@
 // add below
 
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
-        if (const auto is_boss_in_ranking{
-                bossdamageranking::boss_dmg_ranking_manager().is_boss_in_ranking(GetRaceNum())};
-            is_boss_in_ranking)
+        if (const auto& boss_handle{GetBossDamageRankingHandle()}; boss_handle.is_assigned())
         {
-            bossdamageranking::boss_dmg_ranking_manager().damage_process(
-                pAttacker, {GetRaceNum(), static_cast<DWORD>(GetVID())}, dam);
+            bossdamageranking::boss_dmg_ranking_manager().damage_process(pAttacker, boss_handle, dam);
         }
 #endif
 
@@ -62,12 +59,9 @@
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
     if (IsPC())
     {
-        if (const auto is_boss_in_ranking{
-        bossdamageranking::boss_dmg_ranking_manager().is_boss_in_ranking(pkVictim->GetRaceNum())};
-    is_boss_in_ranking)
+        if (const auto& boss_handle{pkVictim->GetBossDamageRankingHandle()}; boss_handle.is_assigned())
         {
-            bossdamageranking::boss_dmg_ranking_manager().add_player_to_list(
-                this, {pkVictim->GetRaceNum(), static_cast<DWORD>(pkVictim->GetVID())});
+            bossdamageranking::boss_dmg_ranking_manager().add_player_to_list(this, boss_handle);
         }
     }
 
@@ -24,8 +24,9 @@
         bossdamageranking::BossDamageRankingBossInfo boss_info{};
         boss_info.mob_vnum = dwVnum;
         boss_info.mob_vid = ch->GetVID();
+        boss_info.map_index = lMapIndex;
         boss_info.max_hp = ch->GetMaxHP();
 
-        bossdamageranking::boss_dmg_ranking_manager().add_boss_to_list(boss_info);
+        ch->SetBossDamageRankingHandle(bossdamageranking::boss_dmg_ranking_manager().add_boss_to_list(boss_info));
     }
 #endif
\ No newline at end of file
@@ -16,9 +16,9 @@ void CHARACTER::AttackedByFire(LPCHARACTER pkAttacker, int amount, int count)
 // add below
 
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
-    if (bossdamageranking::boss_dmg_ranking_manager().is_boss_in_ranking(GetRaceNum()))
+    if (const auto& boss_handle{GetBossDamageRankingHandle()}; boss_handle.is_assigned())
     {
-        bossdamageranking::boss_dmg_ranking_manager().set_bad_affect({GetRaceNum(), static_cast<DWORD>(GetVID())},
+        bossdamageranking::boss_dmg_ranking_manager().set_bad_affect(boss_handle,
             pkAttacker->GetPlayerID(),
             bossdamageranking::BadAffectType::FIRE);
     }
@@ -33,9 +33,9 @@ void CHARACTER::AttackedByFire(LPCHARACTER pkAttacker, int amount, int count)
 // add below
 
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
-    if (bossdamageranking::boss_dmg_ranking_manager().is_boss_in_ranking(GetRaceNum()))
+    if (const auto& boss_handle{GetBossDamageRankingHandle()}; boss_handle.is_assigned())
     {
-        bossdamageranking::boss_dmg_ranking_manager().set_bad_affect({GetRaceNum(), static_cast<DWORD>(GetVID())},
+        bossdamageranking::boss_dmg_ranking_manager().set_bad_affect(boss_handle,
             pkAttacker->GetPlayerID(),
             bossdamageranking::BadAffectType::POISON);
     }
@@ -50,9 +50,9 @@ void CHARACTER::AttackedByFire(LPCHARACTER pkAttacker, int amount, int count)
 // add below
 
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
-    if (bossdamageranking::boss_dmg_ranking_manager().is_boss_in_ranking(GetRaceNum()))
+    if (const auto& boss_handle{GetBossDamageRankingHandle()}; boss_handle.is_assigned())
     {
-        bossdamageranking::boss_dmg_ranking_manager().set_bad_affect({GetRaceNum(), static_cast<DWORD>(GetVID())},
+        bossdamageranking::boss_dmg_ranking_manager().set_bad_affect(boss_handle,
             pkAttacker->GetPlayerID(),
             bossdamageranking::BadAffectType::BLEED);
     }
@@ -0,0 +1,21 @@
+// find
+
+ACMD(do_reload);
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+ACMD(do_boss_dmg_stats);
+ACMD(do_boss_dmg_trace);
+#endif
+
+// find
+
+	{ "reload",		do_reload,		0,			POS_DEAD,	GM_IMPLEMENTOR	},
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+	{ "boss_dmg_stats",	do_boss_dmg_stats,	0,			POS_DEAD,	GM_IMPLEMENTOR	},
+	{ "boss_dmg_trace",	do_boss_dmg_trace,	0,			POS_DEAD,	GM_IMPLEMENTOR	},
+#endif
@@ -23,4 +23,98 @@ ACMD(do_reload)
 	            ch->ChatPacket(CHAT_TYPE_INFO, "Reloading boss damage ranking.");
                 return;
 	    }
-#endif
\ No newline at end of file
+#endif
+
+// find
+
+ACMD(do_reload)
+
+// add above
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+ACMD(do_boss_dmg_stats)
+{
+	char arg1[256], arg2[256];
+	two_arguments(argument, arg1, sizeof(arg1), arg2, sizeof(arg2));
+
+	auto& boss_dmg_ranking_manager{bossdamageranking::boss_dmg_ranking_manager()};
+
+	if (!*arg1)
+	{
+		for (const auto& line : boss_dmg_ranking_manager.create_stats_report())
+		{
+			ch->ChatPacket(CHAT_TYPE_INFO, "%s", line.c_str());
+		}
+
+		return;
+	}
+
+	if (!strcmp(arg1, "reset"))
+	{
+		boss_dmg_ranking_manager.reset_stats();
+		ch->ChatPacket(CHAT_TYPE_INFO, "Boss damage ranking stats reset.");
+		return;
+	}
+
+	if (!strcmp(arg1, "log"))
+	{
+		uint32_t interval{};
+		str_to_number(interval, arg2);
+
+		boss_dmg_ranking_manager.set_stats_log_interval(interval);
+		ch->ChatPacket(CHAT_TYPE_INFO, "Boss damage ranking stats logged every %u seconds (0: off).",
+			boss_dmg_ranking_manager.get_stats_log_interval());
+		return;
+	}
+
+	ch->ChatPacket(CHAT_TYPE_INFO, "Usage: /boss_dmg_stats [reset | log <seconds>]");
+}
+
+ACMD(do_boss_dmg_trace)
+{
+	char arg1[256], arg2[256];
+	two_arguments(argument, arg1, sizeof(arg1), arg2, sizeof(arg2));
+
+	auto& boss_dmg_ranking_manager{bossdamageranking::boss_dmg_ranking_manager()};
+
+	if (!strcmp(arg1, "on"))
+	{
+		size_t capacity{perfutils::FlightRecorder::default_capacity};
+
+		if (*arg2)
+		{
+			str_to_number(capacity, arg2);
+		}
+
+		boss_dmg_ranking_manager.start_trace(std::clamp<size_t>(capacity, 1024U, 1U << 20));
+		ch->ChatPacket(CHAT_TYPE_INFO, "Boss damage ranking trace started.");
+		return;
+	}
+
+	if (!strcmp(arg1, "off"))
+	{
+		boss_dmg_ranking_manager.stop_trace();
+		ch->ChatPacket(CHAT_TYPE_INFO, "Boss damage ranking trace stopped.");
+		return;
+	}
+
+	if (!strcmp(arg1, "dump"))
+	{
+		const std::string file_name{*arg2 ? arg2 : "boss_dmg_trace.json"};
+
+		if (const auto event_count{boss_dmg_ranking_manager.dump_trace(file_name)}; event_count.has_value())
+		{
+			ch->ChatPacket(CHAT_TYPE_INFO, "Boss damage ranking trace: %zu spans written to %s.", event_count.value(), file_name.c_str());
+		}
+		else
+		{
+			ch->ChatPacket(CHAT_TYPE_INFO, "Boss damage ranking trace: nothing written to %s.", file_name.c_str());
+		}
+
+		return;
+	}
+
+	ch->ChatPacket(CHAT_TYPE_INFO, "Usage: /boss_dmg_trace on [spans] | off | dump [file.json] (tracing: %s)",
+		boss_dmg_ranking_manager.is_tracing() ? "on" : "off");
+}
+#endif
@@ -0,0 +1,63 @@
+// add includes
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+#include "bossdamagerankingmanager.hpp"
+#endif
+
+// find
+
+		TOKEN("channel")
+		{
+			str_to_number(g_bChannel, value_string);
+			continue;
+		}
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+		TOKEN("boss_dmg_ranking_top_limit")
+		{
+			int top_limit{};
+			str_to_number(top_limit, value_string);
+			bossdamageranking::boss_dmg_ranking_manager().set_top_limit(static_cast<uint8_t>(std::clamp(top_limit, 0, 254)));
+			continue;
+		}
+
+		TOKEN("boss_dmg_ranking_broadcast_interval")
+		{
+			uint32_t broadcast_interval{};
+			str_to_number(broadcast_interval, value_string);
+			bossdamageranking::boss_dmg_ranking_manager().set_broadcast_interval(broadcast_interval);
+			continue;
+		}
+
+		TOKEN("boss_dmg_ranking_stats_log_interval")
+		{
+			uint32_t stats_log_interval{};
+			str_to_number(stats_log_interval, value_string);
+			bossdamageranking::boss_dmg_ranking_manager().set_stats_log_interval(stats_log_interval);
+			continue;
+		}
+
+		TOKEN("boss_dmg_ranking_worker_thread")
+		{
+			int worker_thread{};
+			str_to_number(worker_thread, value_string);
+			bossdamageranking::boss_dmg_ranking_manager().set_worker_thread(0 != worker_thread);
+			continue;
+		}
+
+		TOKEN("boss_dmg_ranking_event_log_dir")
+		{
+			bossdamageranking::boss_dmg_ranking_manager().set_event_log_dir(value_string);
+			continue;
+		}
+
+		TOKEN("boss_dmg_ranking_event_log_size")
+		{
+			uint32_t event_log_capacity{};
+			str_to_number(event_log_capacity, value_string);
+			bossdamageranking::boss_dmg_ranking_manager().set_event_log_capacity(std::clamp<uint32_t>(event_log_capacity, 1024U, 1U << 20));
+			continue;
+		}
+#endif
\ No newline at end of file
@@ -0,0 +1,16 @@
+// add includes
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+#include "bossdamagerankingmanager.hpp"
+#endif
+
+// find
+
+CDungeon::~CDungeon()
+{
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+    bossdamageranking::boss_dmg_ranking_manager().erase_bosses_on_map(m_lMapIndex);
+#endif
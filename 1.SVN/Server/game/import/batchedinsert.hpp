@@ -0,0 +1,114 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef BATCHEDINSERT_HPP
+#define BATCHEDINSERT_HPP
+
+#include "db.h"
+
+namespace dbutils
+{
+
+/**
+ * @brief Counters of a batched insert
+ */
+struct BatchedInsertStats
+{
+    uint64_t rows{};
+    uint64_t statements{};
+};
+
+/**
+ * @brief Multi-row INSERT statement filled row by row and sent through the asynchronous DB queue
+ *
+ * @details Rows are appended to one statement until the next row would not fit
+ * into max_query_length; the statement is then queued and a new one started.
+ * Nothing is sent until that happens or flush() is called, so rows of many
+ * callers end up in the same statement.
+ */
+class BatchedInsert
+{
+public:
+    /**
+     * @brief Longest statement queued, DBManager::Query formats into a 4 KiB buffer
+     */
+    static constexpr size_t max_query_length{4095U};
+
+    /**
+     * @brief Construct a new BatchedInsert object
+     *
+     * @param insert_prefix The statement up to and including VALUES, e.g. "INSERT INTO t (a, b) VALUES "
+     */
+    explicit BatchedInsert(std::string insert_prefix) : m_insert_prefix{std::move(insert_prefix)} {}
+
+    /**
+     * @brief Append a row
+     *
+     * @param row The parenthesized row values, e.g. "(1,2)"
+     */
+    void add_row(const std::string_view row)
+    {
+        if (!m_query.empty() && m_query.size() + 1U + row.size() > max_query_length)
+        {
+            flush();
+        }
+
+        if (m_query.empty())
+        {
+            m_query.reserve(max_query_length);
+            m_query = m_insert_prefix;
+        }
+        else
+        {
+            m_query += ',';
+        }
+
+        m_query += row;
+        ++m_stats.rows;
+    }
+
+    /**
+     * @brief Queue the pending statement, if any
+     */
+    void flush()
+    {
+        if (m_query.empty())
+        {
+            return;
+        }
+
+        DBManager::instance().Query("%s", m_query.c_str());
+
+        m_query.clear();
+        ++m_stats.statements;
+    }
+
+    /**
+     * @brief Get the insert counters
+     */
+    [[nodiscard]] const BatchedInsertStats& get_stats() const noexcept
+    {
+        return m_stats;
+    }
+
+private:
+    /**
+     * @brief Statement up to and including VALUES
+     */
+    std::string m_insert_prefix{};
+
+    /**
+     * @brief Pending statement, empty if no row is pending
+     */
+    std::string m_query{};
+
+    /**
+     * @brief Insert counters
+     */
+    BatchedInsertStats m_stats{};
+};
+
+} // namespace dbutils
+
+#endif // BATCHEDINSERT_HPP
@@ -11,15 +11,274 @@
 namespace bossdamageranking
 {
 
+namespace
+{
+
+/**
+ * @brief Move a participant or a group into or up a top ranking after its damage grew
+ *
+ * @param slot The participant or group slot
+ * @param damages The damage column
+ * @param top_positions The top position column
+ * @param top_slots The slots of the top ranking, highest damage first
+ * @param top_limit Number of slots kept in the top ranking
+ *
+ * @details Damage never decreases, so a ranked slot can only move up and
+ * an unranked slot can only enter by displacing the last ranked one.
+ */
+void update_top_slots(const uint32_t slot,
+    const std::pmr::vector<uint64_t>& damages,
+    std::pmr::vector<uint8_t>& top_positions,
+    boss_damage_ranking_top_vec_t& top_slots,
+    const uint8_t top_limit)
+{
+    if (0U == top_limit)
+    {
+        return;
+    }
+
+    const auto damage{damages[slot]};
+
+    // most hits come from slots that stay below the last ranked one: decided from the damage column alone
+    if (top_slots.size() == top_limit && top_slots.back() != slot && damages[top_slots.back()] >= damage)
+    {
+        return;
+    }
+
+    auto position{top_positions[slot]};
+
+    if (no_top_position == position)
+    {
+        if (top_slots.size() < top_limit)
+        {
+            position = static_cast<uint8_t>(top_slots.size());
+            top_slots.emplace_back(slot);
+        }
+        else
+        {
+            top_positions[top_slots.back()] = no_top_position;
+            position = static_cast<uint8_t>(top_slots.size() - 1);
+        }
+    }
+
+    // bubble up while the slot above has less damage
+    for (; position > 0U; --position)
+    {
+        const auto upper_slot{top_slots[position - 1U]};
+
+        if (damages[upper_slot] >= damage)
+        {
+            break;
+        }
+
+        top_slots[position] = upper_slot;
+        top_positions[upper_slot] = position;
+    }
+
+    top_slots[position] = slot;
+    top_positions[slot] = position;
+}
+
+} // namespace
+
+/**
+ * @brief Construct a new CBossDamageRankingGroupData object with a top ranking size
+ *
+ * @param top_limit Number of groups kept in the top ranking
+ * @param resource The memory resource providing every group column
+ */
+CBossDamageRankingGroupData::CBossDamageRankingGroupData(const uint8_t top_limit, std::pmr::memory_resource* resource)
+    : m_damages{resource},
+      m_member_counts{resource},
+      m_top_positions{resource},
+      m_profiles{resource},
+      m_name_versions{resource},
+      m_group_index{resource},
+      m_top_groups{resource},
+      m_top_limit{std::min(top_limit, static_cast<uint8_t>(no_top_position - 1))}
+{
+    m_top_groups.reserve(m_top_limit);
+}
+
+/**
+ * @brief Find the group slot of a group, adding the group if needed
+ *
+ * @param profile The group ID and name; a known group takes the name if it changed and is known
+ * @return group_slot_t The group slot
+ */
+group_slot_t CBossDamageRankingGroupData::find_or_add_group(const BossDamageRankingGroupProfile& profile)
+{
+    const auto next_slot{static_cast<group_slot_t>(m_damages.size())};
+
+    const auto [group_slot, inserted]{m_group_index.find_or_insert(profile.group_id, next_slot)};
+
+    if (!inserted)
+    {
+        if (profile.is_name_known) { set_group_name(group_slot, profile.group_name); }
+
+        return group_slot;
+    }
+
+    m_damages.emplace_back(0U);
+    m_member_counts.emplace_back(0U);
+    m_top_positions.emplace_back(no_top_position);
+    m_profiles.emplace_back(profile);
+    m_name_versions.emplace_back(0U);
+
+    update_top_slots(group_slot, m_damages, m_top_positions, m_top_groups, m_top_limit);
+
+    return group_slot;
+}
+
 /**
- * @brief Construct a new CBossDamageRankingPlayerManager object with player
- * info
+ * @brief Rename a group, when its party leader changed
  *
- * @param player_info The player information to initialize the manager with
+ * @param group_slot A valid group slot
+ * @param group_name The current name
+ * @return bool True if the name changed
  */
-CBossDamageRankingPlayerData::CBossDamageRankingPlayerData(boss_damage_ranking_player_info_t&& player_info) noexcept
+bool CBossDamageRankingGroupData::set_group_name(
+    const group_slot_t group_slot, const std::array<char, CHARACTER_NAME_MAX_LEN + 1>& group_name) noexcept
 {
-    m_players.emplace_back(std::move(player_info));
+    auto& profile{m_profiles[group_slot]};
+
+    if (profile.group_name == group_name)
+    {
+        return false;
+    }
+
+    profile.group_name = group_name;
+    ++m_name_versions[group_slot];
+
+    return true;
+}
+
+/**
+ * @brief Count a participant joining a group
+ *
+ * @param group_slot A valid group slot
+ */
+void CBossDamageRankingGroupData::add_member(const group_slot_t group_slot) noexcept
+{
+    ++m_member_counts[group_slot];
+}
+
+/**
+ * @brief Count a participant leaving a group, its damage stays with the group
+ *
+ * @param group_slot A valid group slot
+ */
+void CBossDamageRankingGroupData::remove_member(const group_slot_t group_slot) noexcept
+{
+    if (0U != m_member_counts[group_slot])
+    {
+        --m_member_counts[group_slot];
+    }
+}
+
+/**
+ * @brief Add a member's hit to the damage of a group
+ *
+ * @param group_slot A valid group slot
+ * @param damage The damage to add
+ */
+void CBossDamageRankingGroupData::add_damage(const group_slot_t group_slot, const uint64_t damage)
+{
+    m_damages[group_slot] += damage;
+
+    update_top_slots(group_slot, m_damages, m_top_positions, m_top_groups, m_top_limit);
+}
+
+/**
+ * @brief Retrieve the top ranked group slots in descending order by damage
+ */
+const boss_damage_ranking_top_vec_t& CBossDamageRankingGroupData::get_top_groups() const noexcept
+{
+    return m_top_groups;
+}
+
+/**
+ * @brief Get the number of groups
+ */
+size_t CBossDamageRankingGroupData::get_group_count() const noexcept
+{
+    return m_damages.size();
+}
+
+/**
+ * @brief Get the damage dealt by the members of a group
+ *
+ * @param group_slot A valid group slot
+ */
+uint64_t CBossDamageRankingGroupData::get_damage(const group_slot_t group_slot) const noexcept
+{
+    return m_damages[group_slot];
+}
+
+/**
+ * @brief Get the number of participants in a group
+ *
+ * @param group_slot A valid group slot
+ */
+uint16_t CBossDamageRankingGroupData::get_member_count(const group_slot_t group_slot) const noexcept
+{
+    return m_member_counts[group_slot];
+}
+
+/**
+ * @brief Get the ID and name of a group
+ *
+ * @param group_slot A valid group slot
+ */
+const BossDamageRankingGroupProfile& CBossDamageRankingGroupData::get_group_profile(
+    const group_slot_t group_slot) const noexcept
+{
+    return m_profiles[group_slot];
+}
+
+/**
+ * @brief Get the number of times a group was renamed, so a broadcast finds the renamed rows
+ *
+ * @param group_slot A valid group slot
+ */
+uint16_t CBossDamageRankingGroupData::get_name_version(const group_slot_t group_slot) const noexcept
+{
+    return m_name_versions[group_slot];
+}
+
+/**
+ * @brief Construct a new CBossDamageRankingPlayerData object with a top ranking size
+ *
+ * @param top_limit Number of players kept in the top ranking
+ * @param resource The memory resource providing every participant column
+ */
+CBossDamageRankingPlayerData::CBossDamageRankingPlayerData(
+    const uint8_t top_limit, std::pmr::memory_resource* resource)
+    : m_player_ids{resource},
+      m_damages{resource},
+      m_bad_affect_flags{resource},
+      m_top_positions{resource},
+      m_ranking_versions{resource},
+      m_dps_windows{resource},
+      m_characters{resource},
+      m_profiles{resource},
+      m_participant_groups{resource},
+      m_player_index{resource},
+      m_top_players{resource},
+      m_group_data{CBossDamageRankingGroupData{top_limit, resource}, CBossDamageRankingGroupData{top_limit, resource}},
+      m_top_limit{std::min(top_limit, static_cast<uint8_t>(no_top_position - 1))}
+{
+    m_player_ids.reserve(initial_participant_capacity);
+    m_damages.reserve(initial_participant_capacity);
+    m_bad_affect_flags.reserve(initial_participant_capacity);
+    m_top_positions.reserve(initial_participant_capacity);
+    m_ranking_versions.reserve(initial_participant_capacity);
+    m_dps_windows.reserve(initial_participant_capacity);
+    m_characters.reserve(initial_participant_capacity);
+    m_profiles.reserve(initial_participant_capacity);
+    m_participant_groups.reserve(initial_participant_capacity);
+    m_player_index.reserve(initial_participant_capacity);
+    m_top_players.reserve(m_top_limit);
 }
 
 /**
@@ -27,205 +286,558 @@ CBossDamageRankingPlayerData::CBossDamageRankingPlayerData(boss_damage_ranking_p
  *
  * @param player_id The player's ID to set the flag for.
  * @param flag The bad affect flag to be set.
+ * @return std::optional<player_slot_t> The participant slot of the player, or
+ * std::nullopt if the player is not in the ranking
  *
- * @details This function retrieves the player information for the given
- * player ID and sets the specified bad affect flag. If the player is not
- * found in the ranking, the function exits without making any changes.
+ * @details If the player is not found in the ranking, the function exits
+ * without making any changes.
  */
-void CBossDamageRankingPlayerData::set_bad_affect_flag(uint32_t player_id, BadAffectType flag) const
+std::optional<player_slot_t> CBossDamageRankingPlayerData::set_bad_affect_flag(uint32_t player_id, BadAffectType flag)
 {
-    const auto& player_info_ptr{get_player_info(player_id)};
+    const auto player_slot{m_player_index.find(player_id)};
 
-    if (std::nullopt == player_info_ptr)
+    if (hashutils::FlatIndex<uint32_t>::npos == player_slot)
     {
-        return;
+        return std::nullopt;
     }
 
-    (*player_info_ptr)->bad_affect_flag |= static_cast<uint8_t>(flag);
+    m_bad_affect_flags[player_slot] |= static_cast<uint8_t>(flag);
+
+    return player_slot;
 }
 
 /**
  * @brief Add damage to a player's damage in the ranking
  *
- * @param player_id The character ID.
+ * @param player_slot The participant slot returned by find_or_add_player.
  * @param damage The damage to add
+ * @param now The current time in milliseconds
  *
- * @details This function retrieves the player information for the given
- * player ID and adds the specified damage to the player's damage in the
- * ranking. If the player is not found in the ranking, the function exits
- * without making any changes.
+ * @details The player moves up in the top ranking if the new total
+ * overtakes the players ranked above. The damage is also added to the
+ * current second of the player's DPS window.
+ */
+void CBossDamageRankingPlayerData::add_damage(const player_slot_t player_slot, uint64_t damage, const uint32_t now)
+{
+    if (player_slot >= m_damages.size())
+    {
+        return;
+    }
+
+    m_damages[player_slot] += damage;
+
+    auto& dps_window{m_dps_windows[player_slot]};
+    const auto second{now / 1000U};
+
+    if (no_hit_second == dps_window.first_second)
+    {
+        dps_window.first_second = second;
+        dps_window.last_second = second;
+    }
+
+    if (second != dps_window.last_second)
+    {
+        // clear the buckets of the seconds without a hit, at most the whole window
+        const auto idle_seconds{std::min(second - dps_window.last_second, dps_window_sec)};
+
+        for (uint32_t idle_second{1U}; idle_second <= idle_seconds; ++idle_second)
+        {
+            dps_window.bucket_damages[(dps_window.last_second + idle_second) % dps_window_sec] = 0U;
+        }
+
+        dps_window.last_second = second;
+    }
+
+    auto& bucket_damage{dps_window.bucket_damages[second % dps_window_sec]};
+    bucket_damage = static_cast<uint32_t>(std::min<uint64_t>(bucket_damage + damage, std::numeric_limits<uint32_t>::max()));
+
+    update_top_players(player_slot);
+
+    const auto& participant_groups{m_participant_groups[player_slot]};
+
+    for (size_t group_type{}; group_type < group_type_count; ++group_type)
+    {
+        if (const auto group_slot{participant_groups.group_slots[group_type]}; no_group_slot != group_slot)
+        {
+            m_group_data[group_type].add_damage(group_slot, damage);
+        }
+    }
+}
+
+/**
+ * @brief Check if a participant is cached in the given groups
+ *
+ * @param player_slot A valid participant slot
+ * @param group_ids The participant's current group IDs
+ * @return bool False if the participant joined or left a party or guild since its groups were set
+ */
+bool CBossDamageRankingPlayerData::has_groups(
+    const player_slot_t player_slot, const boss_damage_ranking_group_ids_t& group_ids) const noexcept
+{
+    return m_participant_groups[player_slot].group_ids == group_ids;
+}
+
+/**
+ * @brief Move a participant into its current groups
+ *
+ * @param player_slot A valid participant slot
+ * @param group_profiles The participant's current party and guild, group ID 0 for none
+ * @return bool True if the participant changed groups or a group was renamed
+ *
+ * @details Only the later hits go to the new groups: the damage dealt so far stays
+ * with the groups the participant left.
+ */
+bool CBossDamageRankingPlayerData::set_groups(
+    const player_slot_t player_slot, const boss_damage_ranking_group_profiles_t& group_profiles)
+{
+    if (player_slot >= m_participant_groups.size())
+    {
+        return false;
+    }
+
+    auto& participant_groups{m_participant_groups[player_slot]};
+    bool is_changed{};
+
+    for (size_t group_type{}; group_type < group_type_count; ++group_type)
+    {
+        const auto& group_profile{group_profiles[group_type]};
+        auto& group_slot{participant_groups.group_slots[group_type]};
+        auto& group_data{m_group_data[group_type]};
+
+        if (participant_groups.group_ids[group_type] == group_profile.group_id)
+        {
+            // same party, maybe under a new leader; a member's stand-in name never renames it
+            if (no_group_slot != group_slot && group_profile.is_name_known &&
+                group_data.set_group_name(group_slot, group_profile.group_name))
+            {
+                is_changed = true;
+            }
+
+            continue;
+        }
+
+        is_changed = true;
+
+        if (no_group_slot != group_slot)
+        {
+            group_data.remove_member(group_slot);
+        }
+
+        group_slot = no_group_slot;
+        participant_groups.group_ids[group_type] = group_profile.group_id;
+
+        if (0U == group_profile.group_id)
+        {
+            continue;
+        }
+
+        group_slot = group_data.find_or_add_group(group_profile);
+        group_data.add_member(group_slot);
+    }
+
+    return is_changed;
+}
+
+/**
+ * @brief Find the participant slot of a player
+ *
+ * @param player_id The player ID
+ * @return std::optional<player_slot_t> The participant slot, or std::nullopt if the player is not in the ranking
+ */
+std::optional<player_slot_t> CBossDamageRankingPlayerData::find_player_slot(const uint32_t player_id) const
+{
+    const auto player_slot{m_player_index.find(player_id)};
+
+    if (hashutils::FlatIndex<uint32_t>::npos == player_slot)
+    {
+        return std::nullopt;
+    }
+
+    return player_slot;
+}
+
+/**
+ * @brief Get the parties or the guilds of the fight
+ *
+ * @param group_type An EBossDamageRankingGroupType value
+ */
+const CBossDamageRankingGroupData& CBossDamageRankingPlayerData::get_group_data(const size_t group_type) const noexcept
+{
+    return m_group_data[group_type];
+}
+
+/**
+ * @brief Get the live DPS of a participant
+ *
+ * @param player_slot A valid participant slot
+ * @param now The current time in milliseconds
+ * @return uint64_t The damage of the last dps_window_sec seconds, per second
+ *
+ * @details Only computed for the damage rows being sent. A participant who
+ * started hitting less than dps_window_sec seconds ago is averaged over the
+ * seconds since the first hit.
+ */
+uint64_t CBossDamageRankingPlayerData::get_dps(const player_slot_t player_slot, const uint32_t now) const noexcept
+{
+    const auto& dps_window{m_dps_windows[player_slot]};
+    const auto now_second{now / 1000U};
+    const auto elapsed_seconds{now_second - dps_window.last_second};
+
+    if (no_hit_second == dps_window.first_second || elapsed_seconds >= dps_window_sec)
+    {
+        return 0U;
+    }
+
+    // the buckets of the seconds since the latest hit are out of the window
+    uint64_t window_damage{};
+
+    for (uint32_t age{}; age + elapsed_seconds < dps_window_sec; ++age)
+    {
+        window_damage += dps_window.bucket_damages[(dps_window.last_second + dps_window_sec - age) % dps_window_sec];
+    }
+
+    return window_damage / std::min(now_second - dps_window.first_second + 1U, dps_window_sec);
+}
+
+/**
+ * @brief Move a participant into or up the top ranking after its damage grew
+ *
+ * @param player_slot The participant slot
+ *
+ * @details Damage never decreases, so a ranked player can only move up and
+ * an unranked player can only enter by displacing the last ranked one.
+ */
+void CBossDamageRankingPlayerData::update_top_players(const player_slot_t player_slot)
+{
+    update_top_slots(player_slot, m_damages, m_top_positions, m_top_players, m_top_limit);
+}
+
+/**
+ * @brief Retrieve the top ranked participant slots in descending order by damage
+ *
+ * @return boss_damage_ranking_top_vec_t& The top ranked participant slots
+ */
+const boss_damage_ranking_top_vec_t& CBossDamageRankingPlayerData::get_top_players() const noexcept
+{
+    return m_top_players;
+}
+
+/**
+ * @brief Get the number of participants
+ */
+size_t CBossDamageRankingPlayerData::get_player_count() const noexcept
+{
+    return m_player_ids.size();
+}
+
+/**
+ * @brief Get the player ID column
+ *
+ * @return std::pmr::vector<uint32_t>& The player IDs, indexed by participant slot
+ */
+const std::pmr::vector<uint32_t>& CBossDamageRankingPlayerData::get_player_ids() const noexcept
+{
+    return m_player_ids;
+}
+
+/**
+ * @brief Get the cached character column
+ *
+ * @return std::pmr::vector<LPCHARACTER>& The online characters, nullptr for the
+ * participants that left, indexed by participant slot
+ */
+const std::pmr::vector<LPCHARACTER>& CBossDamageRankingPlayerData::get_characters() const noexcept
+{
+    return m_characters;
+}
+
+/**
+ * @brief Cache the character of a participant
+ *
+ * @param player_slot A valid participant slot
+ * @param p_character The participant's character
+ * @return bool True if another character (or none) was cached before
  */
-void CBossDamageRankingPlayerData::add_damage(uint32_t player_id, uint64_t damage) const
+bool CBossDamageRankingPlayerData::attach_character(const player_slot_t player_slot, const LPCHARACTER p_character) noexcept
 {
-    const auto& player_info_ptr{get_player_info(player_id)};
+    return std::exchange(m_characters[player_slot], p_character) != p_character;
+}
 
-    if (std::nullopt == player_info_ptr)
+/**
+ * @brief Drop the cached character of a participant, keeping its damage
+ *
+ * @param player_slot The participant slot
+ * @param p_character The character being destroyed; a newer cached character is kept
+ */
+void CBossDamageRankingPlayerData::detach_character(const player_slot_t player_slot, const LPCHARACTER p_character) noexcept
+{
+    if (player_slot >= m_characters.size() || m_characters[player_slot] != p_character)
     {
         return;
     }
 
-    (*player_info_ptr)->damage += damage;
+    m_characters[player_slot] = nullptr;
 }
 
 /**
- * @brief Retrieve the vector of player information sorted in descending order by damage
+ * @brief Get the damage dealt by a participant
  *
- * @details This function returns a vector of player information sorted in descending order by damage.
- * If the C++20 standard library is available, it uses the `std::ranges::sort` algorithm to sort the vector.
- * Otherwise, it uses the `std::sort` algorithm with a custom comparison function to sort the vector.
- * The returned vector is a copy of the internal vector of player information.
+ * @param player_slot A valid participant slot
+ */
+uint64_t CBossDamageRankingPlayerData::get_damage(const player_slot_t player_slot) const noexcept
+{
+    return m_damages[player_slot];
+}
+
+/**
+ * @brief Get the bad affect flags of a participant
  *
- * @return std::vector<boss_damage_ranking_player_info_t> The sorted vector of player information
+ * @param player_slot A valid participant slot
  */
-boss_damage_ranking_player_info_vec_t& CBossDamageRankingPlayerData::get_sorted_player_info_vec()
+uint8_t CBossDamageRankingPlayerData::get_bad_affect_flag(const player_slot_t player_slot) const noexcept
 {
-    static constexpr uint8_t sort_limit{5U};
+    return m_bad_affect_flags[player_slot];
+}
 
-    const auto vec_elm_index{sort_limit < m_players.size() ? sort_limit : m_players.size()};
+/**
+ * @brief Get the ranking version last sent to a participant
+ *
+ * @param player_slot A valid participant slot
+ */
+uint32_t CBossDamageRankingPlayerData::get_ranking_version(const player_slot_t player_slot) const noexcept
+{
+    return m_ranking_versions[player_slot];
+}
+
+/**
+ * @brief Get the name and race of a participant
+ *
+ * @param player_slot A valid participant slot
+ */
+const BossDamageRankingPlayerProfile& CBossDamageRankingPlayerData::get_player_profile(
+    const player_slot_t player_slot) const noexcept
+{
+    return m_profiles[player_slot];
+}
+
+/**
+ * @brief Get the rank of a single participant
+ *
+ * @param player_slot The participant slot
+ * @return uint32_t The 1-based rank, or 0 if the slot is invalid
+ *
+ * @details Top ranked players get their position directly; the others
+ * need one pass over the damage column.
+ */
+uint32_t CBossDamageRankingPlayerData::get_player_rank(const player_slot_t player_slot) const
+{
+    if (player_slot >= m_damages.size())
+    {
+        return 0U;
+    }
+
+    if (const auto top_position{m_top_positions[player_slot]}; no_top_position != top_position)
+    {
+        return top_position + 1U;
+    }
+
+    const auto damage{m_damages[player_slot]};
 
 #if __cplusplus >= 202002L
-    std::ranges::partial_sort(m_players, std::next(m_players.begin(), vec_elm_index), std::ranges::greater{},
-                              &BossDamageRankingPlayerInfo::damage);
+    const auto higher_count{std::ranges::count_if(m_damages, [damage](const uint64_t other) { return other > damage; })};
 #else
-    std::partial_sort(m_players.begin(), std::next(m_players.begin(), vec_elm_index), m_players.end(),
-                      [](const auto& lhs, const auto& rhs) { return lhs->damage > rhs->damage; });
+    const auto higher_count{
+        std::count_if(m_damages.begin(), m_damages.end(), [damage](const uint64_t other) { return other > damage; })};
 #endif
 
-    return m_players;
+    // ties with the last ranked players do not move a player into the top ranking
+    return std::max(static_cast<uint32_t>(higher_count), static_cast<uint32_t>(m_top_players.size())) + 1U;
 }
 
 /**
- * @brief Get player information from the ranking
+ * @brief Get the rank of every participant
+ *
+ * @return std::vector<uint32_t> The 1-based ranks, indexed by participant slot
  *
- * @param player_id The player's ID to retrieve the information for
- * @return std::optional<BossDamageRankingPlayerInfo*> Optional containing
- * the player info if found, otherwise std::nullopt
+ * @details Sorts the damage values once, so ranking every participant of a
+ * broadcast costs O(N log N) instead of one pass per participant.
  */
-std::optional<BossDamageRankingPlayerInfo*>
-CBossDamageRankingPlayerData::get_player_info(const uint32_t player_id) const noexcept
+std::vector<uint32_t> CBossDamageRankingPlayerData::get_player_ranks() const
 {
-    const auto check_pred_func{[player_id](const boss_damage_ranking_player_info_t& player_info)
-                               { return player_info->player_id == player_id; }};
+    std::vector<uint64_t> damage_vec(m_damages.begin(), m_damages.end());
 
 #if __cplusplus >= 202002L
-    const auto find_iter{std::ranges::find_if(m_players, check_pred_func)};
+    std::ranges::sort(damage_vec, std::ranges::greater{});
 #else
-    const auto find_iter{std::find_if(m_players.begin(), m_players.end(), check_pred_func)};
+    std::sort(damage_vec.begin(), damage_vec.end(), std::greater<>{});
 #endif
 
-    if (find_iter == m_players.cend())
+    std::vector<uint32_t> rank_vec(m_damages.size());
+
+    for (size_t player_slot{}; player_slot < m_damages.size(); ++player_slot)
     {
-        return std::nullopt;
+        if (const auto top_position{m_top_positions[player_slot]}; no_top_position != top_position)
+        {
+            rank_vec[player_slot] = top_position + 1U;
+            continue;
+        }
+
+        const auto higher_count{
+            std::lower_bound(damage_vec.begin(), damage_vec.end(), m_damages[player_slot], std::greater<>{}) -
+            damage_vec.begin()};
+
+        rank_vec[player_slot] =
+            std::max(static_cast<uint32_t>(higher_count), static_cast<uint32_t>(m_top_players.size())) + 1U;
     }
 
-    return find_iter->get();
+    return rank_vec;
 }
 
 /**
- * @brief Check if the player is in the ranking
+ * @brief Remember the ranking version last sent to a participant
  *
- * @param player_id The player's ID to check
- * @return bool True if the player is in the ranking, false otherwise
+ * @param player_slot The participant slot
+ * @param ranking_version The ranking version the participant holds now
  */
-bool CBossDamageRankingPlayerData::is_player_in_ranking(const uint32_t player_id) const
+void CBossDamageRankingPlayerData::set_ranking_version(const player_slot_t player_slot, const uint32_t ranking_version)
 {
-    if (m_players.empty())
+    if (player_slot >= m_ranking_versions.size())
     {
-        return false;
+        return;
     }
 
-    const auto& player_iter{get_player_info(player_id)};
+    m_ranking_versions[player_slot] = ranking_version;
+}
 
-    return player_iter.has_value();
+/**
+ * @brief Check if the player is in the ranking
+ *
+ * @param player_id The player's ID to check
+ * @return bool True if the player is in the ranking, false otherwise
+ */
+bool CBossDamageRankingPlayerData::is_player_in_ranking(const uint32_t player_id) const
+{
+    return hashutils::FlatIndex<uint32_t>::npos != m_player_index.find(player_id);
 }
 
 /**
- * @brief Add a player to the boss damage ranking.
+ * @brief Find the participant slot of a player, adding the player if needed.
  *
  * @param p_character A pointer to the character object representing the
  * player.
+ * @return std::optional<player_slot_result_t> The participant slot and whether
+ * the player was added, or std::nullopt if the character is invalid
+ *
+ * @details A known participant costs one index probe. The
+ * returned slot stays valid for the lifetime of this object. A new
+ * participant gets its character cached.
  */
-void CBossDamageRankingPlayerData::add_player(const LPCHARACTER p_character)
+std::optional<player_slot_result_t> CBossDamageRankingPlayerData::find_or_add_player(const LPCHARACTER p_character)
 {
     if (nullptr == p_character)
     {
-        return;
+        return std::nullopt;
     }
 
-    if (is_player_in_ranking(p_character->GetPlayerID()))
+    // the profile is only needed for a new participant, which is rare next to the hits
+    if (const auto player_slot{m_player_index.find(p_character->GetPlayerID())};
+        hashutils::FlatIndex<uint32_t>::npos != player_slot)
     {
-        return;
+        return std::make_pair(player_slot, false);
     }
 
-#if __cplusplus >= 202002L
-    // Designated Initialization, C++20
-    BossDamageRankingPlayerInfo info{
-        .player_id = p_character->GetPlayerID(),
-        .race = static_cast<uint8_t>(p_character->GetRaceNum()),
-    };
-#else
-    BossDamageRankingPlayerInfo info{p_character->GetPlayerID(), static_cast<uint8_t>(p_character->GetRaceNum())};
-#endif
-
-    strncpy(info.player_name.data(), p_character->GetName(), info.player_name.size() - 1);
+    BossDamageRankingPlayerProfile profile{};
+    strncpy(profile.player_name.data(), p_character->GetName(), profile.player_name.size() - 1);
+    profile.race = static_cast<uint8_t>(p_character->GetRaceNum());
 
-    m_players.emplace_back(std::make_unique<BossDamageRankingPlayerInfo>(info));
+    return find_or_add_player(p_character->GetPlayerID(), profile, p_character);
 }
 
 /**
- * @brief Calc damage percent of each player
+ * @brief Find the participant slot of a player, adding the player with a given profile if needed.
  *
- * @param boss_max_hp
+ * @param player_id The player's ID
+ * @param profile The name and race shown in the top ranking, only read for a new participant
+ * @param p_character The character cached for a new participant, nullptr for none
+ * @return player_slot_result_t The participant slot and whether the player was added
  *
- * @details Maybe changeable func..
+ * @details Used where no character may be touched, such as the ranking worker thread.
  */
-void CBossDamageRankingPlayerData::set_player_info_damage_percent(boss_hp_t boss_max_hp) const
+player_slot_result_t CBossDamageRankingPlayerData::find_or_add_player(
+    const uint32_t player_id, const BossDamageRankingPlayerProfile& profile, const LPCHARACTER p_character)
 {
-    if (0U == boss_max_hp)
-    {
-        return;
-    }
+    const auto next_slot{static_cast<player_slot_t>(m_player_ids.size())};
 
-    for (const auto& player : m_players)
+    const auto [player_slot, inserted]{m_player_index.find_or_insert(player_id, next_slot)};
+
+    if (!inserted)
     {
-        static constexpr auto min_percent{std::numeric_limits<unsigned long long>::min()};
+        return std::make_pair(player_slot, false);
+    }
 
-        static constexpr auto max_percent{100ULL};
+    m_player_ids.emplace_back(player_id);
+    m_damages.emplace_back(0U);
+    m_bad_affect_flags.emplace_back(0U);
+    m_top_positions.emplace_back(no_top_position);
+    m_ranking_versions.emplace_back(0U);
+    m_dps_windows.emplace_back();
+    m_characters.emplace_back(p_character);
+    m_profiles.emplace_back(profile);
+    m_participant_groups.emplace_back();
 
-        static constexpr uint8_t damage_multiplier{100U};
+    // fill free top ranking places with new participants, as before
+    update_top_players(player_slot);
 
-        const auto percent{std::clamp(player->damage * damage_multiplier / boss_max_hp, min_percent, max_percent)};
-        player->percent_damage = static_cast<uint8_t>(percent);
-    }
+    return std::make_pair(player_slot, true);
 }
 
 /**
  * @brief Construct a new CBossDamageRankingBossData object
  *
  * @param boss_info The boss information to initialize the manager with
+ * @param policy The tracking policy of the boss
+ * @param upstream The memory resource the fight's arena draws its blocks from
+ * @param event_log_capacity The number of hits and bad affects kept in the event log, 0 for none
  */
-CBossDamageRankingBossData::CBossDamageRankingBossData(boss_damage_ranking_boss_info_t boss_info) noexcept
-    : mp_boss_info{std::move(boss_info)}
+CBossDamageRankingBossData::CBossDamageRankingBossData(const BossDamageRankingBossInfo& boss_info,
+    const BossDamageRankingPolicy& policy,
+    std::pmr::memory_resource* upstream,
+    const uint32_t event_log_capacity)
+    : m_arena{initial_arena_size, upstream},
+      m_boss_info{boss_info},
+      m_policy{policy},
+      m_player_data{policy.top_limit, &m_arena},
+      m_event_log{event_log_capacity, get_dword_time(), &m_arena},
+      m_sent_rows{&m_arena},
+      m_sent_group_rows{std::pmr::vector<BossDamageRankingGroupRowState>{&m_arena},
+          std::pmr::vector<BossDamageRankingGroupRowState>{&m_arena}}
 {
-    mp_player_data = std::make_unique<CBossDamageRankingPlayerData>();
 }
 
 /**
  * @brief Get the boss information
  *
- * @return BossDamageRankingBossInfo* The boss information, or nullptr if not
- * found
+ * @return BossDamageRankingBossInfo* The boss information
  */
-BossDamageRankingBossInfo* CBossDamageRankingBossData::get_boss_info() const noexcept 
+const BossDamageRankingBossInfo* CBossDamageRankingBossData::get_boss_info() const noexcept
 {
-    return mp_boss_info.get(); 
+    return &m_boss_info;
+}
+
+/**
+ * @brief Get the tracking policy
+ *
+ * @return const BossDamageRankingPolicy& The tracking policy
+ */
+const BossDamageRankingPolicy& CBossDamageRankingBossData::get_policy() const noexcept
+{
+    return m_policy;
 }
 
 /**
  * @brief Retrieve the player data object associated with this boss data.
  *
- * @return CBossDamageRankingPlayerData* A pointer to the player data object,
- * or nullptr if the object is not valid.
+ * @return CBossDamageRankingPlayerData* A pointer to the player data object.
  *
  * @details
  * This function is used to retrieve the player data object associated with
@@ -233,9 +845,111 @@ BossDamageRankingBossInfo* CBossDamageRankingBossData::get_boss_info() const noe
  * players who have damaged the boss, such as their player ID, job, level,
  * and damage dealt.
  */
-CBossDamageRankingPlayerData* CBossDamageRankingBossData::get_player_data() const noexcept
+CBossDamageRankingPlayerData* CBossDamageRankingBossData::get_player_data() noexcept
+{
+    return &m_player_data;
+}
+
+/**
+ * @brief Get the log of the latest hits and bad affects of the fight
+ *
+ * @return CBossDamageRankingEventLog& The event log, disabled if the fight records none
+ */
+CBossDamageRankingEventLog& CBossDamageRankingBossData::get_event_log() noexcept
+{
+    return m_event_log;
+}
+
+/**
+ * @brief Mark the ranking as changed since the last broadcast
+ *
+ * @return bool True if the boss was clean before this call
+ */
+bool CBossDamageRankingBossData::mark_dirty() noexcept
+{
+    return !std::exchange(m_dirty, true);
+}
+
+/**
+ * @brief Check if the ranking changed since the last broadcast
+ *
+ * @return bool True if a broadcast is pending
+ */
+bool CBossDamageRankingBossData::is_dirty() const noexcept
+{
+    return m_dirty;
+}
+
+/**
+ * @brief Check if the broadcast interval elapsed since the last broadcast
+ *
+ * @param now The current time in milliseconds
+ * @param interval The minimum time between two broadcasts in milliseconds
+ * @return bool True if the ranking may be broadcast again
+ */
+bool CBossDamageRankingBossData::can_broadcast(const uint32_t now, const uint32_t interval) const noexcept
+{
+    return !m_broadcasted || now - m_last_broadcast_time >= interval;
+}
+
+/**
+ * @brief Record a broadcast and clear the dirty flag
+ *
+ * @param now The current time in milliseconds
+ */
+void CBossDamageRankingBossData::set_broadcasted(const uint32_t now) noexcept
+{
+    m_last_broadcast_time = now;
+    m_broadcasted = true;
+    m_dirty = false;
+}
+
+/**
+ * @brief Get the version of the last broadcast ranking
+ *
+ * @return uint32_t The ranking version, 0 before the first broadcast
+ */
+uint32_t CBossDamageRankingBossData::get_ranking_version() const noexcept
+{
+    return m_ranking_version;
+}
+
+/**
+ * @brief Start a new ranking version
+ *
+ * @return uint32_t The new ranking version
+ */
+uint32_t CBossDamageRankingBossData::next_ranking_version() noexcept
+{
+    // 0 is reserved for "nothing received yet"
+    if (0U == ++m_ranking_version)
+    {
+        m_ranking_version = 1U;
+    }
+
+    return m_ranking_version;
+}
+
+/**
+ * @brief Get the top ranking rows as they were last broadcast
+ *
+ * @return std::pmr::vector<BossDamageRankingRowState>& The last broadcast rows
+ */
+std::pmr::vector<BossDamageRankingRowState>& CBossDamageRankingBossData::get_sent_rows() noexcept
+{
+    return m_sent_rows;
+}
+
+/**
+ * @brief Get the group ranking rows of a group type as they were last broadcast
+ *
+ * @param group_type An EBossDamageRankingGroupType value
+ * @return std::pmr::vector<BossDamageRankingGroupRowState>& The last broadcast rows
+ */
+std::pmr::vector<BossDamageRankingGroupRowState>& CBossDamageRankingBossData::get_sent_group_rows(
+    const size_t group_type) noexcept
 {
-    return mp_player_data.get();
+    return m_sent_group_rows[group_type];
 }
 
 } // namespace bossdamageranking
@@ -2,6 +2,10 @@
 #define BOSSDAMAGERANKING_HPP
 
 #include "../../common/tables.h"
+#include "bossdamagerankingeventlog.hpp"
+#include "bossdamagerankinghandle.hpp"
+#include "flatindex.hpp"
+#include "memorypool.hpp"
 
 namespace bossdamageranking
 {
@@ -16,34 +20,362 @@ enum class BadAffectType : uint8_t
 #endif
 };
 
+/**
+ * @brief Why a boss fight ended, stored with the persisted fight result
+ */
+enum class EBossDamageRankingFightEnd : uint8_t
+{
+    KILLED,
+    DESPAWNED,
+    MAP_CLOSED,
+    UNRANKED,
+    REAPED,
+};
+
 /**
  * @brief Boss HP variable type
  */
 using boss_hp_t = decltype(TMobTable::dwMaxHP);
 
 /**
- * @brief Boss damage ranking player info
+ * @brief Boss damage ranking player profile
+ *
+ * @details Only read when a ranking is serialized, so it is kept apart from
+ * the columns the hit path scans.
  */
-struct BossDamageRankingPlayerInfo
+struct BossDamageRankingPlayerProfile
 {
-    uint32_t player_id{};
     std::array<char, CHARACTER_NAME_MAX_LEN + 1> player_name{};
     uint8_t race{};
-    uint64_t damage{};
-    uint8_t bad_affect_flag{};
+};
+
+/**
+ * @brief Top ranking row as it was last broadcast, used to find changed rows
+ */
+struct BossDamageRankingRowState
+{
+    uint32_t player_id{};
     uint8_t percent_damage{};
+    uint8_t bad_affect_flag{};
+};
+
+/**
+ * @brief Seconds covered by the live DPS of a participant
+ */
+inline constexpr uint32_t dps_window_sec{10U};
+
+/**
+ * @brief Marks a DPS window whose participant did not hit yet
+ */
+inline constexpr uint32_t no_hit_second{std::numeric_limits<uint32_t>::max()};
+
+/**
+ * @brief Damage of a participant over the latest seconds, one bucket per second
+ *
+ * @details A fixed ring indexed by second: a hit only clears the buckets of the
+ * seconds that passed since the previous one, so no hit history is kept.
+ */
+struct BossDamageRankingDpsWindow
+{
+    /**
+     * @brief Damage per second, saturated at 2^32 - 1
+     */
+    std::array<uint32_t, dps_window_sec> bucket_damages{};
+
+    /**
+     * @brief Second of the latest hit, in get_dword_time() seconds
+     */
+    uint32_t last_second{};
+
+    /**
+     * @brief Second of the first hit, no_hit_second before it, so a fresh attacker is not averaged over the whole window
+     */
+    uint32_t first_second{no_hit_second};
+};
+
+/**
+ * @brief Marks a participant that is not in the top ranking
+ */
+inline constexpr uint8_t no_top_position{std::numeric_limits<uint8_t>::max()};
+
+/**
+ * @brief Default number of players kept in the top ranking
+ */
+inline constexpr uint8_t default_top_limit{5U};
+
+/**
+ * @brief Default minimum time between two ranking broadcasts of the same boss, in milliseconds
+ */
+inline constexpr uint32_t default_broadcast_interval{250U};
+
+/**
+ * @brief Seconds between two checks that every tracked boss is still alive
+ */
+inline constexpr int boss_reap_interval_sec{30};
+
+/**
+ * @brief Seconds between two flushes of the batched fight results
+ */
+inline constexpr int fight_result_flush_interval_sec{5};
+
+/**
+ * @brief Seconds between two announcements of the config checksum to the other cores
+ */
+inline constexpr int config_checksum_interval_sec{60};
+
+/**
+ * @brief Longest interval in seconds between two stats reports, keeps PASSES_PER_SEC within an int
+ */
+inline constexpr uint32_t max_stats_log_interval_sec{3600U};
+
+/**
+ * @brief First block size of a per-fight arena, enough for a few dozen participants
+ */
+inline constexpr size_t initial_arena_size{8U * 1024U};
+
+/**
+ * @brief Participant records reserved up front in a new fight's arena
+ */
+inline constexpr size_t initial_participant_capacity{32U};
+
+/**
+ * @brief Query of the boss damage ranking config
+ */
+inline constexpr const char* boss_config_query{
+    "SELECT boss_vnum, top_n, broadcast_interval_ms, max_participants, track_dot_flags, persist_result "
+    "FROM boss_dmg_ranking"};
+
+/**
+ * @brief Index of a participant record inside its boss' player data
+ */
+using player_slot_t = hashutils::FlatIndex<uint32_t>::slot_t;
+
+/**
+ * @brief Participant slot and whether the participant was just added
+ */
+using player_slot_result_t = std::pair<player_slot_t, bool>;
+
+/**
+ * @brief Participant slots of a top ranking, highest damage first
+ */
+using boss_damage_ranking_top_vec_t = std::pmr::vector<player_slot_t>;
+
+/**
+ * @brief Number of group rankings of a boss, parties and guilds, in EBossDamageRankingGroupType order
+ */
+inline constexpr size_t group_type_count{2U};
+
+/**
+ * @brief Index of a group record inside its group data
+ */
+using group_slot_t = hashutils::FlatIndex<uint32_t>::slot_t;
+
+/**
+ * @brief Marks a participant that belongs to no group of a type
+ */
+inline constexpr group_slot_t no_group_slot{hashutils::FlatIndex<uint32_t>::npos};
+
+/**
+ * @brief Group IDs of a participant, 0 for none: the per-core party ID and the guild ID
+ */
+using boss_damage_ranking_group_ids_t = std::array<uint32_t, group_type_count>;
+
+/**
+ * @brief Boss damage ranking group profile
+ */
+struct BossDamageRankingGroupProfile
+{
+    /**
+     * @brief The per-core party ID or the guild ID, 0 for no group
+     */
+    uint32_t group_id{};
+
+    /**
+     * @brief The guild name or the party leader's name, a member's name while the leader is on another core
+     */
+    std::array<char, CHARACTER_NAME_MAX_LEN + 1> group_name{};
+
+    /**
+     * @brief False when the party leader is on another core and the name is only a member's,
+     * which then names a new group but never renames a known one
+     */
+    bool is_name_known{};
 };
 
 /**
- * @brief Boss damage ranking player info type alias
+ * @brief Party and guild profiles of a participant, in EBossDamageRankingGroupType order
  */
-using boss_damage_ranking_player_info_t = std::unique_ptr<BossDamageRankingPlayerInfo>;
+using boss_damage_ranking_group_profiles_t = std::array<BossDamageRankingGroupProfile, group_type_count>;
 
 /**
- * @brief Boss damage ranking player info vector type alias
+ * @brief Groups a participant's hits are added to
  */
-using boss_damage_ranking_player_info_vec_t = std::vector<boss_damage_ranking_player_info_t>;
+struct BossDamageRankingParticipantGroups
+{
+    boss_damage_ranking_group_ids_t group_ids{};
+    std::array<group_slot_t, group_type_count> group_slots{no_group_slot, no_group_slot};
+};
 
+/**
+ * @brief Group ranking row as it was last broadcast, used to find changed rows
+ */
+struct BossDamageRankingGroupRowState
+{
+    uint32_t group_id{};
+    uint16_t name_version{};
+    uint16_t member_count{};
+    uint8_t percent_damage{};
+};
+
+/**
+ * @brief Groups of one type (parties or guilds) of one boss, stored as one column per field
+ *
+ * @details Fed by the participants' hits through the group slot they cache, so the
+ * group totals are never rebuilt from the participants. A group keeps its damage
+ * when its members leave.
+ */
+class CBossDamageRankingGroupData
+{
+public:
+    /**
+     * @brief Construct a new CBossDamageRankingGroupData object
+     */
+    CBossDamageRankingGroupData() noexcept = default;
+
+    /**
+     * @brief Construct a new CBossDamageRankingGroupData object with a top ranking size
+     *
+     * @param top_limit Number of groups kept in the top ranking
+     * @param resource The memory resource providing every group column
+     */
+    explicit CBossDamageRankingGroupData(uint8_t top_limit, std::pmr::memory_resource* resource);
+
+    /**
+     * @brief Find the group slot of a group, adding the group if needed
+     *
+     * @param profile The group ID and name; a known group takes the name if it changed and is known
+     * @return group_slot_t The group slot
+     */
+    group_slot_t find_or_add_group(const BossDamageRankingGroupProfile& profile);
+
+    /**
+     * @brief Rename a group, when its party leader changed
+     *
+     * @param group_slot A valid group slot
+     * @param group_name The current name
+     * @return bool True if the name changed
+     */
+    bool set_group_name(group_slot_t group_slot, const std::array<char, CHARACTER_NAME_MAX_LEN + 1>& group_name) noexcept;
+
+    /**
+     * @brief Count a participant joining a group
+     *
+     * @param group_slot A valid group slot
+     */
+    void add_member(group_slot_t group_slot) noexcept;
+
+    /**
+     * @brief Count a participant leaving a group, its damage stays with the group
+     *
+     * @param group_slot A valid group slot
+     */
+    void remove_member(group_slot_t group_slot) noexcept;
+
+    /**
+     * @brief Add a member's hit to the damage of a group
+     *
+     * @param group_slot A valid group slot
+     * @param damage The damage to add
+     */
+    void add_damage(group_slot_t group_slot, uint64_t damage);
+
+    /**
+     * @brief Retrieve the top ranked group slots in descending order by damage
+     */
+    [[nodiscard]] const boss_damage_ranking_top_vec_t& get_top_groups() const noexcept;
+
+    /**
+     * @brief Get the number of groups
+     */
+    [[nodiscard]] size_t get_group_count() const noexcept;
+
+    /**
+     * @brief Get the damage dealt by the members of a group
+     *
+     * @param group_slot A valid group slot
+     */
+    [[nodiscard]] uint64_t get_damage(group_slot_t group_slot) const noexcept;
+
+    /**
+     * @brief Get the number of participants in a group
+     *
+     * @param group_slot A valid group slot
+     */
+    [[nodiscard]] uint16_t get_member_count(group_slot_t group_slot) const noexcept;
+
+    /**
+     * @brief Get the ID and name of a group
+     *
+     * @param group_slot A valid group slot
+     */
+    [[nodiscard]] const BossDamageRankingGroupProfile& get_group_profile(group_slot_t group_slot) const noexcept;
+
+    /**
+     * @brief Get the number of times a group was renamed, so a broadcast finds the renamed rows
+     *
+     * @param group_slot A valid group slot
+     */
+    [[nodiscard]] uint16_t get_name_version(group_slot_t group_slot) const noexcept;
+
+private:
+    /**
+     * @brief Damage dealt, indexed by group slot
+     */
+    std::pmr::vector<uint64_t> m_damages{};
+
+    /**
+     * @brief Participants in the group, indexed by group slot
+     */
+    std::pmr::vector<uint16_t> m_member_counts{};
+
+    /**
+     * @brief Position in the top ranking or no_top_position, indexed by group slot
+     */
+    std::pmr::vector<uint8_t> m_top_positions{};
+
+    /**
+     * @brief IDs and names, indexed by group slot
+     */
+    std::pmr::vector<BossDamageRankingGroupProfile> m_profiles{};
+
+    /**
+     * @brief Renames, indexed by group slot
+     */
+    std::pmr::vector<uint16_t> m_name_versions{};
+
+    /**
+     * @brief Group ID to group slot index
+     */
+    hashutils::FlatIndex<uint32_t> m_group_index{};
+
+    /**
+     * @brief Group slots of the top ranking, highest damage first
+     */
+    boss_damage_ranking_top_vec_t m_top_groups{};
+
+    /**
+     * @brief Number of groups kept in the top ranking
+     */
+    uint8_t m_top_limit{default_top_limit};
+};
+
+/**
+ * @brief Participants of one boss, stored as one column per field
+ *
+ * @details Every column is indexed by participant slot. The hit path only
+ * touches the damage column (and the top ranking columns when the player is
+ * ranked); names and races sit in a side table read during serialization.
+ */
 class CBossDamageRankingPlayerData
 {
 public:
@@ -53,49 +385,190 @@ public:
     CBossDamageRankingPlayerData() noexcept = default;
 
     /**
-     * @brief Construct a new CBossDamageRankingPlayerManager object with
-     * player info
+     * @brief Construct a new CBossDamageRankingPlayerData object with a top ranking size
      *
-     * @param player_info The player information to initialize the manager with
+     * @param top_limit Number of players kept in the top ranking
+     * @param resource The memory resource providing every participant column
      */
-    explicit CBossDamageRankingPlayerData(boss_damage_ranking_player_info_t&& player_info) noexcept;
+    explicit CBossDamageRankingPlayerData(
+        uint8_t top_limit, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     /**
      * @brief Set a bad affect flag for a player in the ranking.
      *
      * @param player_id The player's ID to set the flag for.
      * @param flag The bad affect flag to be set.
+     * @return std::optional<player_slot_t> The participant slot of the player, or
+     * std::nullopt if the player is not in the ranking
      *
-     * @details This function retrieves the player information for the given
-     * player ID and sets the specified bad affect flag. If the player is not
-     * found in the ranking, the function exits without making any changes.
+     * @details If the player is not found in the ranking, the function exits
+     * without making any changes.
      */
-    void set_bad_affect_flag(uint32_t player_id, BadAffectType flag) const;
+    std::optional<player_slot_t> set_bad_affect_flag(uint32_t player_id, BadAffectType flag);
 
     /**
      * @brief Add damage to a player's damage in the ranking
      *
-     * @param player_id The character ID.
+     * @param player_slot The participant slot returned by find_or_add_player.
      * @param damage The damage to add
+     * @param now The current time in milliseconds
      *
-     * @details This function retrieves the player information for the given
-     * player ID and adds the specified damage to the player's damage in the
-     * ranking. If the player is not found in the ranking, the function exits
-     * without making any changes.
+     * @details The player moves up in the top ranking if the new total
+     * overtakes the players ranked above. The damage is also added to the
+     * current second of the player's DPS window and to the groups the player
+     * is cached in.
+     */
+    void add_damage(player_slot_t player_slot, uint64_t damage, uint32_t now);
+
+    /**
+     * @brief Check if a participant is cached in the given groups
+     *
+     * @param player_slot A valid participant slot
+     * @param group_ids The participant's current group IDs
+     * @return bool False if the participant joined or left a party or guild since its groups were set
+     */
+    [[nodiscard]] bool has_groups(player_slot_t player_slot, const boss_damage_ranking_group_ids_t& group_ids) const noexcept;
+
+    /**
+     * @brief Move a participant into its current groups
+     *
+     * @param player_slot A valid participant slot
+     * @param group_profiles The participant's current party and guild, group ID 0 for none
+     * @return bool True if the participant changed groups or a group was renamed
+     *
+     * @details Only the later hits go to the new groups: the damage dealt so far stays
+     * with the groups the participant left.
+     */
+    bool set_groups(player_slot_t player_slot, const boss_damage_ranking_group_profiles_t& group_profiles);
+
+    /**
+     * @brief Find the participant slot of a player
+     *
+     * @param player_id The player ID
+     * @return std::optional<player_slot_t> The participant slot, or std::nullopt if the player is not in the ranking
+     */
+    [[nodiscard]] std::optional<player_slot_t> find_player_slot(uint32_t player_id) const;
+
+    /**
+     * @brief Get the parties or the guilds of the fight
+     *
+     * @param group_type An EBossDamageRankingGroupType value
+     */
+    [[nodiscard]] const CBossDamageRankingGroupData& get_group_data(size_t group_type) const noexcept;
+
+    /**
+     * @brief Retrieve the top ranked participant slots in descending order by damage
+     *
+     * @return boss_damage_ranking_top_vec_t& The top ranked participant slots
+     */
+    [[nodiscard]] const boss_damage_ranking_top_vec_t& get_top_players() const noexcept;
+
+    /**
+     * @brief Get the number of participants
+     */
+    [[nodiscard]] size_t get_player_count() const noexcept;
+
+    /**
+     * @brief Get the player ID column
+     *
+     * @return std::pmr::vector<uint32_t>& The player IDs, indexed by participant slot
      */
-    void add_damage(uint32_t player_id, uint64_t damage) const;
+    [[nodiscard]] const std::pmr::vector<uint32_t>& get_player_ids() const noexcept;
 
     /**
-     * @brief Retrieve the vector of player information sorted in descending order by damage
+     * @brief Get the cached character column
      *
-     * @details This function returns a vector of player information sorted in descending order by damage.
-     * If the C++20 standard library is available, it uses the `std::ranges::sort` algorithm to sort the vector.
-     * Otherwise, it uses the `std::sort` algorithm with a custom comparison function to sort the vector.
-     * The returned vector is a copy of the internal vector of player information.
+     * @return std::pmr::vector<LPCHARACTER>& The online characters, nullptr for the
+     * participants that left, indexed by participant slot
+     */
+    [[nodiscard]] const std::pmr::vector<LPCHARACTER>& get_characters() const noexcept;
+
+    /**
+     * @brief Cache the character of a participant
      *
-     * @return std::vector<boss_damage_ranking_player_info_t> The sorted vector of player information
+     * @param player_slot A valid participant slot
+     * @param p_character The participant's character
+     * @return bool True if another character (or none) was cached before
      */
-    boss_damage_ranking_player_info_vec_t& get_sorted_player_info_vec();
+    bool attach_character(player_slot_t player_slot, LPCHARACTER p_character) noexcept;
+
+    /**
+     * @brief Drop the cached character of a participant, keeping its damage
+     *
+     * @param player_slot The participant slot
+     * @param p_character The character being destroyed; a newer cached character is kept
+     */
+    void detach_character(player_slot_t player_slot, LPCHARACTER p_character) noexcept;
+
+    /**
+     * @brief Get the damage dealt by a participant
+     *
+     * @param player_slot A valid participant slot
+     */
+    [[nodiscard]] uint64_t get_damage(player_slot_t player_slot) const noexcept;
+
+    /**
+     * @brief Get the bad affect flags of a participant
+     *
+     * @param player_slot A valid participant slot
+     */
+    [[nodiscard]] uint8_t get_bad_affect_flag(player_slot_t player_slot) const noexcept;
+
+    /**
+     * @brief Get the live DPS of a participant
+     *
+     * @param player_slot A valid participant slot
+     * @param now The current time in milliseconds
+     * @return uint64_t The damage of the last dps_window_sec seconds, per second
+     *
+     * @details Only computed for the damage rows being sent. A participant who
+     * started hitting less than dps_window_sec seconds ago is averaged over the
+     * seconds since the first hit.
+     */
+    [[nodiscard]] uint64_t get_dps(player_slot_t player_slot, uint32_t now) const noexcept;
+
+    /**
+     * @brief Get the ranking version last sent to a participant
+     *
+     * @param player_slot A valid participant slot
+     */
+    [[nodiscard]] uint32_t get_ranking_version(player_slot_t player_slot) const noexcept;
+
+    /**
+     * @brief Get the name and race of a participant
+     *
+     * @param player_slot A valid participant slot
+     */
+    [[nodiscard]] const BossDamageRankingPlayerProfile& get_player_profile(player_slot_t player_slot) const noexcept;
+
+    /**
+     * @brief Get the rank of a single participant
+     *
+     * @param player_slot The participant slot
+     * @return uint32_t The 1-based rank, or 0 if the slot is invalid
+     *
+     * @details Top ranked players get their position directly; the others
+     * need one pass over the damage column.
+     */
+    [[nodiscard]] uint32_t get_player_rank(player_slot_t player_slot) const;
+
+    /**
+     * @brief Get the rank of every participant
+     *
+     * @return std::vector<uint32_t> The 1-based ranks, indexed by participant slot
+     *
+     * @details Sorts the damage values once, so ranking every participant of a
+     * broadcast costs O(N log N) instead of one pass per participant.
+     */
+    [[nodiscard]] std::vector<uint32_t> get_player_ranks() const;
+
+    /**
+     * @brief Remember the ranking version last sent to a participant
+     *
+     * @param player_slot The participant slot
+     * @param ranking_version The ranking version the participant holds now
+     */
+    void set_ranking_version(player_slot_t player_slot, uint32_t ranking_version);
 
     /**
      * @brief Check if the player is in the ranking
@@ -106,36 +579,107 @@ public:
     [[nodiscard]] bool is_player_in_ranking(uint32_t player_id) const;
 
     /**
-     * @brief Add a player to the boss damage ranking.
+     * @brief Find the participant slot of a player, adding the player if needed.
      *
      * @param p_character A pointer to the character object representing the
      * player.
+     * @return std::optional<player_slot_result_t> The participant slot and whether
+     * the player was added, or std::nullopt if the character is invalid
+     *
+     * @details A known participant costs one index probe. The
+     * returned slot stays valid for the lifetime of this object. A new
+     * participant gets its character cached.
      */
-    void add_player(LPCHARACTER p_character);
+    std::optional<player_slot_result_t> find_or_add_player(LPCHARACTER p_character);
 
     /**
-     * @brief Calc damage percent of each player
+     * @brief Find the participant slot of a player, adding the player with a given profile if needed.
      *
-     * @param boss_max_hp
+     * @param player_id The player's ID
+     * @param profile The name and race shown in the top ranking, only read for a new participant
+     * @param p_character The character cached for a new participant, nullptr for none
+     * @return player_slot_result_t The participant slot and whether the player was added
      *
-     * @details Maybe changeable func..
+     * @details Used where no character may be touched, such as the ranking worker thread.
      */
-    void set_player_info_damage_percent(boss_hp_t boss_max_hp) const;
+    player_slot_result_t find_or_add_player(
+        uint32_t player_id, const BossDamageRankingPlayerProfile& profile, LPCHARACTER p_character = nullptr);
 
 private:
     /**
-     * @brief Get player information from the ranking
+     * @brief Move a participant into or up the top ranking after its damage grew
      *
-     * @param player_id The player's ID to retrieve the information for
-     * @return std::optional<BossDamageRankingPlayerInfo*> Optional containing
-     * the player info if found, otherwise std::nullopt
+     * @param player_slot The participant slot
+     *
+     * @details Damage never decreases, so a ranked player can only move up and
+     * an unranked player can only enter by displacing the last ranked one.
+     */
+    void update_top_players(player_slot_t player_slot);
+
+    /**
+     * @brief Player IDs, indexed by participant slot
+     */
+    std::pmr::vector<uint32_t> m_player_ids{};
+
+    /**
+     * @brief Damage dealt, indexed by participant slot
      */
-    [[nodiscard]] std::optional<BossDamageRankingPlayerInfo*> get_player_info(uint32_t player_id) const noexcept;
+    std::pmr::vector<uint64_t> m_damages{};
 
     /**
-     * @brief Players data
+     * @brief BadAffectType flags, indexed by participant slot
      */
-    boss_damage_ranking_player_info_vec_t m_players{};
+    std::pmr::vector<uint8_t> m_bad_affect_flags{};
+
+    /**
+     * @brief Position in the top ranking or no_top_position, indexed by participant slot
+     */
+    std::pmr::vector<uint8_t> m_top_positions{};
+
+    /**
+     * @brief Ranking version last sent, indexed by participant slot
+     */
+    std::pmr::vector<uint32_t> m_ranking_versions{};
+
+    /**
+     * @brief Per-second damage of the latest seconds, indexed by participant slot
+     */
+    std::pmr::vector<BossDamageRankingDpsWindow> m_dps_windows{};
+
+    /**
+     * @brief Online characters, nullptr once they are destroyed, indexed by participant slot
+     */
+    std::pmr::vector<LPCHARACTER> m_characters{};
+
+    /**
+     * @brief Names and races, indexed by participant slot
+     */
+    std::pmr::vector<BossDamageRankingPlayerProfile> m_profiles{};
+
+    /**
+     * @brief Party and guild the hits are added to, indexed by participant slot
+     */
+    std::pmr::vector<BossDamageRankingParticipantGroups> m_participant_groups{};
+
+    /**
+     * @brief Player ID to participant slot index
+     */
+    hashutils::FlatIndex<uint32_t> m_player_index{};
+
+    /**
+     * @brief Participant slots of the top ranking, highest damage first
+     */
+    boss_damage_ranking_top_vec_t m_top_players{};
+
+    /**
+     * @brief Parties and guilds, in EBossDamageRankingGroupType order
+     */
+    std::array<CBossDamageRankingGroupData, group_type_count> m_group_data{};
+
+    /**
+     * @brief Number of players kept in the top ranking
+     */
+    uint8_t m_top_limit{default_top_limit};
 };
 
 /**
@@ -152,9 +696,117 @@ struct BossDamageRankingIdData
  */
 struct BossDamageRankingBossInfo : BossDamageRankingIdData
 {
+    long map_index{};
+    uint32_t spawn_time{};
     boss_hp_t max_hp{};
+    uint64_t damage_percent_reciprocal{};
 };
 
+/**
+ * @brief Tracking policy of one boss, resolved from its boss_dmg_ranking row when it spawns
+ */
+struct BossDamageRankingPolicy
+{
+    /**
+     * @brief Number of players kept in the top ranking
+     */
+    uint8_t top_limit{default_top_limit};
+
+    /**
+     * @brief Minimum time between two ranking broadcasts, in milliseconds
+     */
+    uint32_t broadcast_interval{default_broadcast_interval};
+
+    /**
+     * @brief Most participants tracked, 0 for no limit
+     */
+    uint32_t max_participants{};
+
+    /**
+     * @brief Whether poison, fire and bleed flags are tracked
+     */
+    bool track_dot_flags{true};
+
+    /**
+     * @brief Whether the fight result is persisted
+     */
+    bool persist_result{true};
+};
+
+/**
+ * @brief Fractional bits of BossDamageRankingBossInfo::damage_percent_reciprocal
+ */
+inline constexpr uint8_t damage_percent_shift{56U};
+
+/**
+ * @brief Highest max HP for which the reciprocal gives the exact percent
+ *
+ * @details With R = ceil(100 * 2^56 / h) = 100 * 2^56 / h + e, e < 1, and 100 * d = q * h + r,
+ * d * R = q * 2^56 + r * 2^56 / h + d * e. The shift yields q as long as d * e < 2^56 / h,
+ * which d <= h guarantees up to h = 2^28. The product stays below 100 * 2^56 + h < 2^63.
+ */
+inline constexpr uint64_t max_damage_percent_reciprocal_hp{1ULL << 28U};
+
+/**
+ * @brief Compute the fixed-point factor turning damage into percent of the boss HP
+ *
+ * @param max_hp The boss max HP
+ * @return uint64_t 100 / max_hp with damage_percent_shift fractional bits, rounded up;
+ * 0 if max_hp is 0 or above max_damage_percent_reciprocal_hp
+ */
+[[nodiscard]] constexpr uint64_t calc_damage_percent_reciprocal(const boss_hp_t max_hp) noexcept
+{
+    const auto divisor{static_cast<uint64_t>(max_hp)};
+
+    if (0U == divisor || divisor > max_damage_percent_reciprocal_hp)
+    {
+        return 0U;
+    }
+
+    constexpr uint64_t percent_scale{100ULL << damage_percent_shift};
+
+    return (percent_scale + divisor - 1U) / divisor;
+}
+
+/**
+ * @brief Compute the damage percent of a player
+ *
+ * @param damage The damage dealt by the player
+ * @param boss_info The boss information holding the precomputed reciprocal
+ * @return uint8_t The damage in percent of the boss max HP, at most 100
+ *
+ * @details Only a multiplication and a shift; damage is capped at max_hp
+ * first, so the product cannot overflow. Bosses above
+ * max_damage_percent_reciprocal_hp have no reciprocal and fall back to a division.
+ */
+[[nodiscard]] constexpr uint8_t calc_damage_percent(const uint64_t damage, const BossDamageRankingBossInfo& boss_info) noexcept
+{
+    constexpr uint64_t max_percent{100U};
+
+    const auto max_hp{static_cast<uint64_t>(boss_info.max_hp)};
+
+    if (0U == max_hp)
+    {
+        return 0U;
+    }
+
+    const auto capped_damage{std::min(damage, max_hp)};
+
+    if (0U == boss_info.damage_percent_reciprocal)
+    {
+        return static_cast<uint8_t>(capped_damage * max_percent / max_hp);
+    }
+
+    return static_cast<uint8_t>(
+        std::min((capped_damage * boss_info.damage_percent_reciprocal) >> damage_percent_shift, max_percent));
+}
+
+// the last HP kept on the reciprocal, and a HP above it where a 56-bit reciprocal gave 11%
+static_assert(99U == calc_damage_percent((1U << 28U) - 1U,
+    BossDamageRankingBossInfo{{}, {}, {}, 1U << 28U, calc_damage_percent_reciprocal(1U << 28U)}));
+static_assert(10U == calc_damage_percent(409109741U,
+    BossDamageRankingBossInfo{{}, {}, {}, 3719179464U, calc_damage_percent_reciprocal(3719179464U)}));
+
 /**
  * @brief Compare a BossDamageRankingBossInfo pointer with a BossDamageRankingIdData object for equality.
  *
@@ -169,39 +821,49 @@ struct BossDamageRankingBossInfo : BossDamageRankingIdData
 }
 
 /**
- * @brief Boss damage ranking boss info type alias
+ * @brief State of one boss fight
+ *
+ * @details Every participant record lives in the fight's own arena, which is
+ * released in one step when the boss data is destroyed.
  */
-using boss_damage_ranking_boss_info_t = std::unique_ptr<BossDamageRankingBossInfo>;
-
 class CBossDamageRankingBossData
 {
 public:
-    /**
-     * @brief Construct a new CBossDamageRankingBossData object with default
-     * initialization
-     */
-    CBossDamageRankingBossData() noexcept = default;
-
     /**
      * @brief Construct a new CBossDamageRankingBossData object
      *
      * @param boss_info The boss information to initialize the manager with
+     * @param policy The tracking policy of the boss
+     * @param upstream The memory resource the fight's arena draws its blocks from
+     * @param event_log_capacity The number of hits and bad affects kept in the event log, 0 for none
      */
-    explicit CBossDamageRankingBossData(boss_damage_ranking_boss_info_t boss_info) noexcept;
+    explicit CBossDamageRankingBossData(const BossDamageRankingBossInfo& boss_info,
+        const BossDamageRankingPolicy& policy = {},
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+        uint32_t event_log_capacity = 0U);
+
+    CBossDamageRankingBossData(const CBossDamageRankingBossData&) = delete;
+    CBossDamageRankingBossData& operator=(const CBossDamageRankingBossData&) = delete;
 
     /**
      * @brief Get the boss information
      *
-     * @return BossDamageRankingBossInfo* The boss information, or nullptr if
-     * not found
+     * @return BossDamageRankingBossInfo* The boss information
+     */
+    [[nodiscard]] const BossDamageRankingBossInfo* get_boss_info() const noexcept;
+
+    /**
+     * @brief Get the tracking policy
+     *
+     * @return const BossDamageRankingPolicy& The tracking policy
      */
-    [[nodiscard]] BossDamageRankingBossInfo* get_boss_info() const noexcept;
+    [[nodiscard]] const BossDamageRankingPolicy& get_policy() const noexcept;
 
     /**
      * @brief Retrieve the player data object associated with this boss data.
      *
      * @return CBossDamageRankingPlayerData* A pointer to the player data
-     * object, or nullptr if the object is not valid.
+     * object.
      *
      * @details
      * This function is used to retrieve the player data object associated with
@@ -209,18 +871,129 @@ public:
      * players who have damaged the boss, such as their player ID, job, level,
      * and damage dealt.
      */
-    [[nodiscard]] CBossDamageRankingPlayerData* get_player_data() const noexcept;
+    [[nodiscard]] CBossDamageRankingPlayerData* get_player_data() noexcept;
+
+    /**
+     * @brief Get the log of the latest hits and bad affects of the fight
+     *
+     * @return CBossDamageRankingEventLog& The event log, disabled if the fight records none
+     */
+    [[nodiscard]] CBossDamageRankingEventLog& get_event_log() noexcept;
+
+    /**
+     * @brief Mark the ranking as changed since the last broadcast
+     *
+     * @return bool True if the boss was clean before this call
+     */
+    bool mark_dirty() noexcept;
+
+    /**
+     * @brief Check if the ranking changed since the last broadcast
+     *
+     * @return bool True if a broadcast is pending
+     */
+    [[nodiscard]] bool is_dirty() const noexcept;
+
+    /**
+     * @brief Check if the broadcast interval elapsed since the last broadcast
+     *
+     * @param now The current time in milliseconds
+     * @param interval The minimum time between two broadcasts in milliseconds
+     * @return bool True if the ranking may be broadcast again
+     */
+    [[nodiscard]] bool can_broadcast(uint32_t now, uint32_t interval) const noexcept;
+
+    /**
+     * @brief Record a broadcast and clear the dirty flag
+     *
+     * @param now The current time in milliseconds
+     */
+    void set_broadcasted(uint32_t now) noexcept;
+
+    /**
+     * @brief Get the version of the last broadcast ranking
+     *
+     * @return uint32_t The ranking version, 0 before the first broadcast
+     */
+    [[nodiscard]] uint32_t get_ranking_version() const noexcept;
+
+    /**
+     * @brief Start a new ranking version
+     *
+     * @return uint32_t The new ranking version
+     */
+    uint32_t next_ranking_version() noexcept;
+
+    /**
+     * @brief Get the top ranking rows as they were last broadcast
+     *
+     * @return std::pmr::vector<BossDamageRankingRowState>& The last broadcast rows
+     */
+    [[nodiscard]] std::pmr::vector<BossDamageRankingRowState>& get_sent_rows() noexcept;
+
+    /**
+     * @brief Get the group ranking rows of a group type as they were last broadcast
+     *
+     * @param group_type An EBossDamageRankingGroupType value
+     * @return std::pmr::vector<BossDamageRankingGroupRowState>& The last broadcast rows
+     */
+    [[nodiscard]] std::pmr::vector<BossDamageRankingGroupRowState>& get_sent_group_rows(size_t group_type) noexcept;
 
 private:
     /**
-     * @brief Player data ptr
+     * @brief Arena owning every record of this fight, declared first so it outlives them
+     */
+    std::pmr::monotonic_buffer_resource m_arena;
+
+    /**
+     * @brief Boss information
+     */
+    BossDamageRankingBossInfo m_boss_info{};
+
+    /**
+     * @brief Tracking policy
+     */
+    BossDamageRankingPolicy m_policy{};
+
+    /**
+     * @brief Player data
+     */
+    CBossDamageRankingPlayerData m_player_data;
+
+    /**
+     * @brief Latest hits and bad affects, drawn from the arena
+     */
+    CBossDamageRankingEventLog m_event_log;
+
+    /**
+     * @brief Time of the last ranking broadcast in milliseconds
+     */
+    uint32_t m_last_broadcast_time{};
+
+    /**
+     * @brief Ranking changed since the last broadcast
+     */
+    bool m_dirty{};
+
+    /**
+     * @brief At least one broadcast was sent
+     */
+    bool m_broadcasted{};
+
+    /**
+     * @brief Version of the last broadcast ranking
+     */
+    uint32_t m_ranking_version{};
+
+    /**
+     * @brief Top ranking rows as they were last broadcast
      */
-    std::unique_ptr<CBossDamageRankingPlayerData> mp_player_data{};
+    std::pmr::vector<BossDamageRankingRowState> m_sent_rows;
 
     /**
-     * @brief @brief
+     * @brief Group ranking rows as they were last broadcast, in EBossDamageRankingGroupType order
      */
-    boss_damage_ranking_boss_info_t mp_boss_info{};
+    std::array<std::pmr::vector<BossDamageRankingGroupRowState>, group_type_count> m_sent_group_rows;
 };
 
 } // namespace bossdamageranking
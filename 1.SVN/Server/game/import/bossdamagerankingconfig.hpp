@@ -0,0 +1,106 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef BOSSDAMAGERANKINGCONFIG_HPP
+#define BOSSDAMAGERANKINGCONFIG_HPP
+
+#include "bossdamageranking.hpp"
+#include "vnumfilter.hpp"
+
+namespace bossdamageranking
+{
+
+/**
+ * @brief Settings of one ranked boss vnum, one row of boss_dmg_ranking
+ */
+struct BossDamageRankingBossSettings
+{
+    uint32_t mob_vnum{};
+
+    /**
+     * @brief Top ranking size, the core default if not set
+     */
+    std::optional<uint8_t> top_limit{};
+
+    /**
+     * @brief Broadcast interval in milliseconds, the core default if not set
+     */
+    std::optional<uint32_t> broadcast_interval{};
+
+    /**
+     * @brief Most participants tracked, 0 for no limit
+     */
+    uint32_t max_participants{};
+
+    bool track_dot_flags{true};
+    bool persist_result{true};
+
+    /**
+     * @brief Resolve the settings into the policy of a spawned boss
+     *
+     * @param core_top_limit The top ranking size of the core
+     * @param core_broadcast_interval The broadcast interval of the core
+     * @return BossDamageRankingPolicy The policy
+     */
+    [[nodiscard]] BossDamageRankingPolicy make_policy(
+        const uint8_t core_top_limit, const uint32_t core_broadcast_interval) const noexcept
+    {
+        return {top_limit.value_or(core_top_limit),
+            broadcast_interval.value_or(core_broadcast_interval),
+            max_participants,
+            track_dot_flags,
+            persist_result};
+    }
+};
+
+/**
+ * @brief Snapshot of the boss_dmg_ranking table
+ *
+ * @details Built once per load away from the hit path and published whole;
+ * a published snapshot is never modified, a reload replaces it.
+ */
+struct BossDamageRankingConfig
+{
+    /**
+     * @brief Filter of the ranked boss vnums
+     */
+    hashutils::VnumFilter boss_vnum_filter{};
+
+    /**
+     * @brief Settings of the ranked boss vnums, sorted by vnum
+     */
+    std::vector<BossDamageRankingBossSettings> boss_settings_vec{};
+
+    /**
+     * @brief Time the database load of the snapshot was requested, kept by the cores it is shared with
+     */
+    uint32_t loaded_at{};
+
+    /**
+     * @brief Find the settings of a boss vnum
+     *
+     * @param mob_vnum The mob vnum
+     * @return const BossDamageRankingBossSettings* The settings, or nullptr if the vnum is not ranked
+     */
+    [[nodiscard]] const BossDamageRankingBossSettings* find_boss_settings(const uint32_t mob_vnum) const noexcept
+    {
+        const auto it{std::lower_bound(boss_settings_vec.begin(),
+            boss_settings_vec.end(),
+            mob_vnum,
+            [](const BossDamageRankingBossSettings& settings, const uint32_t vnum) { return settings.mob_vnum < vnum; })};
+
+        if (boss_settings_vec.end() == it || it->mob_vnum != mob_vnum) { return nullptr; }
+
+        return &*it;
+    }
+};
+
+/**
+ * @brief Shared handle of a published config snapshot
+ */
+using boss_damage_ranking_config_t = std::shared_ptr<const BossDamageRankingConfig>;
+
+} // namespace bossdamageranking
+
+#endif // BOSSDAMAGERANKINGCONFIG_HPP
@@ -0,0 +1,315 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef BOSSDAMAGERANKINGEVENTLOG_HPP
+#define BOSSDAMAGERANKINGEVENTLOG_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * Only standard and POSIX headers: the offline reader in tools/bossdmglog
+ * includes this file for the on-disk layout.
+ */
+
+namespace bossdamageranking
+{
+
+/**
+ * @brief One recorded hit or bad affect of a fight, 16 bytes
+ */
+struct BossDamageRankingLogEvent
+{
+    /**
+     * @brief Milliseconds since the boss was added
+     */
+    uint32_t relative_ms{};
+
+    /**
+     * @brief Participant slot, an index into the participant table of the file
+     */
+    uint32_t player_slot{};
+
+    /**
+     * @brief Damage of the hit, 0 for a bad affect
+     */
+    uint32_t damage{};
+
+    /**
+     * @brief BadAffectType of a bad affect, 0 for a hit
+     */
+    uint8_t affect_type{};
+
+    uint8_t reserved[3]{};
+};
+
+/**
+ * @brief Magic at the start of an event log file
+ */
+inline constexpr char event_log_magic[4]{'B', 'D', 'R', 'L'};
+
+/**
+ * @brief Version of the event log file layout
+ */
+inline constexpr uint16_t event_log_version{1U};
+
+/**
+ * @brief Extension of the event log files
+ */
+inline constexpr const char* event_log_extension{".bdrl"};
+
+/**
+ * @brief Default number of events kept per boss, 128 KiB
+ */
+inline constexpr uint32_t default_event_log_capacity{1U << 13};
+
+/**
+ * @brief Header of an event log file
+ *
+ * @details Followed by participant_count BossDamageRankingLogParticipant records,
+ * indexed by participant slot, then event_count BossDamageRankingLogEvent records,
+ * oldest first. Every field is little endian, as written by the core.
+ */
+struct BossDamageRankingLogHeader
+{
+    char magic[4]{};
+    uint16_t version{};
+
+    /**
+     * @brief EBossDamageRankingFightEnd
+     */
+    uint8_t fight_end{};
+
+    uint8_t reserved{};
+    uint32_t mob_vnum{};
+    uint32_t mob_vid{};
+    int32_t map_index{};
+
+    /**
+     * @brief Unix time the boss was added
+     */
+    uint32_t spawn_time{};
+
+    /**
+     * @brief Milliseconds between the boss being added and the log being written
+     */
+    uint32_t duration_ms{};
+
+    uint32_t participant_count{};
+    uint32_t event_count{};
+    uint32_t reserved2{};
+    uint64_t max_hp{};
+
+    /**
+     * @brief Oldest events overwritten because the ring was full
+     */
+    uint64_t dropped_event_count{};
+};
+
+/**
+ * @brief Participant of an event log file
+ */
+struct BossDamageRankingLogParticipant
+{
+    /**
+     * @brief Total damage, which the events only sum up to if none was dropped
+     */
+    uint64_t damage{};
+
+    uint32_t player_id{};
+    uint8_t race{};
+
+    /**
+     * @brief BadAffectType flags
+     */
+    uint8_t bad_affect_flag{};
+
+    char player_name[26]{};
+};
+
+static_assert(16U == sizeof(BossDamageRankingLogEvent));
+static_assert(56U == sizeof(BossDamageRankingLogHeader));
+static_assert(40U == sizeof(BossDamageRankingLogParticipant));
+
+/**
+ * @brief Append-only ring of the latest hits and bad affects of one fight
+ *
+ * @details The ring is allocated once, from the fight's arena, and never grows: a
+ * long fight keeps its latest events and counts the ones it overwrote. An empty
+ * log (capacity 0) records nothing and costs one branch per event.
+ */
+class CBossDamageRankingEventLog
+{
+public:
+    /**
+     * @brief Construct a new CBossDamageRankingEventLog object
+     *
+     * @param capacity The number of events kept, rounded up to a power of two, 0 to record nothing
+     * @param start_ms The time the fight started, in milliseconds
+     * @param resource The memory resource providing the ring
+     */
+    CBossDamageRankingEventLog(const uint32_t capacity, const uint32_t start_ms, std::pmr::memory_resource* resource)
+        : m_event_vec{resource},
+          m_start_ms{start_ms}
+    {
+        if (0U == capacity)
+        {
+            return;
+        }
+
+        uint32_t ring_size{1U};
+
+        while (ring_size < capacity)
+        {
+            ring_size <<= 1U;
+        }
+
+        m_event_vec.resize(ring_size);
+    }
+
+    /**
+     * @brief Check if events are recorded
+     */
+    [[nodiscard]] bool is_enabled() const noexcept
+    {
+        return !m_event_vec.empty();
+    }
+
+    /**
+     * @brief Append an event, overwriting the oldest one if the ring is full
+     *
+     * @param now The current time in milliseconds
+     * @param player_slot The participant slot
+     * @param damage The damage of a hit, 0 for a bad affect
+     * @param affect_type The BadAffectType of a bad affect, 0 for a hit
+     */
+    void record(const uint32_t now, const uint32_t player_slot, const uint64_t damage, const uint8_t affect_type) noexcept
+    {
+        auto& event{m_event_vec[m_recorded_count & (m_event_vec.size() - 1U)]};
+        event.relative_ms = now - m_start_ms;
+        event.player_slot = player_slot;
+        event.damage = static_cast<uint32_t>(std::min<uint64_t>(damage, std::numeric_limits<uint32_t>::max()));
+        event.affect_type = affect_type;
+        ++m_recorded_count;
+    }
+
+    /**
+     * @brief Get the time the fight started, in milliseconds
+     */
+    [[nodiscard]] uint32_t get_start_ms() const noexcept
+    {
+        return m_start_ms;
+    }
+
+    /**
+     * @brief Get the number of events held by the ring
+     */
+    [[nodiscard]] size_t get_event_count() const noexcept
+    {
+        return static_cast<size_t>(std::min<uint64_t>(m_recorded_count, m_event_vec.size()));
+    }
+
+    /**
+     * @brief Get the number of events overwritten because the ring was full
+     */
+    [[nodiscard]] uint64_t get_dropped_count() const noexcept
+    {
+        return m_recorded_count - get_event_count();
+    }
+
+    /**
+     * @brief Copy the held events, oldest first
+     *
+     * @param p_dest Room for get_event_count() events
+     */
+    void copy_events(BossDamageRankingLogEvent* p_dest) const noexcept
+    {
+        if (0U == m_recorded_count)
+        {
+            return;
+        }
+
+        if (m_recorded_count <= m_event_vec.size())
+        {
+            std::memcpy(p_dest, m_event_vec.data(), get_event_count() * sizeof(BossDamageRankingLogEvent));
+            return;
+        }
+
+        const auto first_index{static_cast<size_t>(m_recorded_count & (m_event_vec.size() - 1U))};
+
+        // the ring wrapped: the oldest event sits where the next one would be written
+        const auto tail_count{m_event_vec.size() - first_index};
+        std::memcpy(p_dest, m_event_vec.data() + first_index, tail_count * sizeof(BossDamageRankingLogEvent));
+        std::memcpy(p_dest + tail_count, m_event_vec.data(), first_index * sizeof(BossDamageRankingLogEvent));
+    }
+
+private:
+    std::pmr::vector<BossDamageRankingLogEvent> m_event_vec;
+    uint64_t m_recorded_count{};
+    uint32_t m_start_ms{};
+};
+
+/**
+ * @brief Write an event log file through a shared memory mapping
+ *
+ * @param path The file to create or truncate
+ * @param header The header, with participant_count and event_count set
+ * @param participant_vec The participants, indexed by participant slot
+ * @param event_log The events
+ * @return bool False if the file could not be created or mapped
+ *
+ * @details The file is sized up front and filled in place, so the core never
+ * blocks on write(); the kernel writes the pages back on its own.
+ */
+[[nodiscard]] inline bool write_event_log_file(const std::string& path,
+    const BossDamageRankingLogHeader& header,
+    const std::vector<BossDamageRankingLogParticipant>& participant_vec,
+    const CBossDamageRankingEventLog& event_log)
+{
+    const auto participant_bytes{participant_vec.size() * sizeof(BossDamageRankingLogParticipant)};
+    const auto file_size{sizeof(BossDamageRankingLogHeader) + participant_bytes +
+                         event_log.get_event_count() * sizeof(BossDamageRankingLogEvent)};
+
+    const auto file_descriptor{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+
+    if (-1 == file_descriptor)
+    {
+        return false;
+    }
+
+    if (0 != ::ftruncate(file_descriptor, static_cast<off_t>(file_size)))
+    {
+        ::close(file_descriptor);
+        return false;
+    }
+
+    auto* const p_mapping{::mmap(nullptr, file_size, PROT_WRITE, MAP_SHARED, file_descriptor, 0)};
+    ::close(file_descriptor);
+
+    if (MAP_FAILED == p_mapping)
+    {
+        return false;
+    }
+
+    auto* const p_bytes{static_cast<char*>(p_mapping)};
+    std::memcpy(p_bytes, &header, sizeof(header));
+    std::memcpy(p_bytes + sizeof(header), participant_vec.data(), participant_bytes);
+    event_log.copy_events(
+        reinterpret_cast<BossDamageRankingLogEvent*>(p_bytes + sizeof(header) + participant_bytes));
+
+    return 0 == ::munmap(p_mapping, file_size);
+}
+
+} // namespace bossdamageranking
+
+#endif // BOSSDAMAGERANKINGEVENTLOG_HPP
@@ -0,0 +1,44 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef BOSSDAMAGERANKINGHANDLE_HPP
+#define BOSSDAMAGERANKINGHANDLE_HPP
+
+namespace bossdamageranking
+{
+
+/**
+ * @brief Handle of a boss tracked by the damage ranking manager
+ *
+ * @details Kept on the boss CHARACTER so the hit path reaches its tracker
+ * without any lookup. The generation changes every time the slot is freed,
+ * so a handle that outlived its boss no longer resolves.
+ */
+struct BossDamageRankingHandle
+{
+    /**
+     * @brief Slot value of a handle that was never assigned
+     */
+    static constexpr uint32_t invalid_slot{std::numeric_limits<uint32_t>::max()};
+
+    uint32_t slot{invalid_slot};
+    uint32_t generation{};
+
+    /**
+     * @brief Check if the handle was assigned to a boss
+     */
+    [[nodiscard]] bool is_assigned() const noexcept
+    {
+        return invalid_slot != slot;
+    }
+};
+
+/**
+ * @brief Recipient slot of a character whose profile was never sent to the ranking worker
+ */
+inline constexpr uint32_t no_recipient_slot{std::numeric_limits<uint32_t>::max()};
+
+} // namespace bossdamageranking
+
+#endif // BOSSDAMAGERANKINGHANDLE_HPP
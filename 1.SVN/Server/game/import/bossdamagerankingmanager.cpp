@@ -8,398 +8,2371 @@
 #include "bossdamagerankingmanager.hpp"
 #include "char.h"
 #include "char_manager.h"
+#include "config.h"
 #include "db.h"
+#include "guild.h"
 #include "mob_manager.h"
-#include "networkutils.hpp"
 #include "p2p.h"
+#include "party.h"
 
 namespace bossdamageranking {
 
+namespace {
+
+/**
+ * @brief Get the current party and guild of a character
+ *
+ * @param p_character A valid character
+ * @return boss_damage_ranking_group_ids_t The party ID and the guild ID, 0 for none
+ *
+ * @details A party keeps its ID when its leader changes, so its damage stays on one row.
+ */
+boss_damage_ranking_group_ids_t get_group_ids(const LPCHARACTER p_character)
+{
+    boss_damage_ranking_group_ids_t group_ids{};
+
+    if (auto* const p_party{p_character->GetParty()}; nullptr != p_party)
+    {
+        group_ids[static_cast<size_t>(EBossDamageRankingGroupType::PARTY)] = p_party->GetBossDamageRankingPartyID();
+    }
+
+    if (auto* const p_guild{p_character->GetGuild()}; nullptr != p_guild)
+    {
+        group_ids[static_cast<size_t>(EBossDamageRankingGroupType::GUILD)] = p_guild->GetID();
+    }
+
+    return group_ids;
+}
+
+/**
+ * @brief Pack the group IDs of a character into the key cached on it
+ *
+ * @param group_ids The IDs returned by get_group_ids
+ * @return uint64_t The party ID in the high half, the guild ID in the low half
+ */
+uint64_t get_group_key(const boss_damage_ranking_group_ids_t& group_ids) noexcept
+{
+    return (static_cast<uint64_t>(group_ids[static_cast<size_t>(EBossDamageRankingGroupType::PARTY)]) << 32U) |
+           group_ids[static_cast<size_t>(EBossDamageRankingGroupType::GUILD)];
+}
+
+/**
+ * @brief Create the party and guild profiles of a character
+ *
+ * @param p_character A valid character
+ * @param group_ids The IDs returned by get_group_ids
+ * @return boss_damage_ranking_group_profiles_t The group profiles
+ *
+ * @details A party is named after its leader; a leader on another core is not at
+ * hand, so a new party row is then named after the member that brought it in,
+ * and the other members keep that name until the leader is seen.
+ */
+boss_damage_ranking_group_profiles_t create_group_profiles(
+    const LPCHARACTER p_character, const boss_damage_ranking_group_ids_t& group_ids)
+{
+    boss_damage_ranking_group_profiles_t group_profiles{};
+
+    for (size_t group_type{}; group_type < group_type_count; ++group_type)
+    {
+        group_profiles[group_type].group_id = group_ids[group_type];
+    }
+
+    if (auto& party_profile{group_profiles[static_cast<size_t>(EBossDamageRankingGroupType::PARTY)]};
+        0U != party_profile.group_id)
+    {
+        auto* const p_leader{p_character->GetParty()->GetLeaderCharacter()};
+        snprintf(party_profile.group_name.data(),
+            party_profile.group_name.size(),
+            "%s",
+            (nullptr != p_leader ? p_leader : p_character)->GetName());
+        party_profile.is_name_known = nullptr != p_leader;
+    }
+
+    if (auto& guild_profile{group_profiles[static_cast<size_t>(EBossDamageRankingGroupType::GUILD)]};
+        0U != guild_profile.group_id)
+    {
+        snprintf(guild_profile.group_name.data(), guild_profile.group_name.size(), "%s", p_character->GetGuild()->GetName());
+        guild_profile.is_name_known = true;
+    }
+
+    return group_profiles;
+}
+
+} // namespace
+
 /**
  * @brief Boss damage ranking manager instance
  */
-CBossDamageRankingManager& boss_dmg_ranking_manager()
+CBossDamageRankingManager& boss_dmg_ranking_manager()
+{
+    return CBossDamageRankingManager::instance();
+}
+
+/**
+ * @brief Initialize the boss damage ranking manager
+ *
+ * @details Loads the config with a blocking query, so it is only meant for the
+ * boot, before any player is connected. A failed query keeps the current config.
+ */
+void CBossDamageRankingManager::initialize() noexcept
+{
+    if (m_use_worker_thread && nullptr == mp_worker)
+    {
+        mp_worker = std::make_unique<CBossDamageRankingWorker>();
+        sys_log(0, "CBossDamageRankingManager::initialize - rankings computed on a worker thread");
+    }
+
+    const auto loaded_at{static_cast<uint32_t>(get_global_time())};
+    const std::unique_ptr<SQLMsg> msg(DBManager::instance().DirectQuery(boss_config_query));
+
+    auto config{create_config(msg.get())};
+
+    if (std::nullopt == config) { return; }
+
+    config->loaded_at = loaded_at;
+    publish_config(std::make_shared<const BossDamageRankingConfig>(std::move(config.value())));
+}
+
+/**
+ * @brief Load the config from the database without blocking the game thread
+ *
+ * @param share_with_peers Whether the loaded snapshot is sent to the other cores.
+ *
+ * @details The query goes through the asynchronous DB queue; its snapshot is built
+ * when the result comes back and published on the next pulse. A result that
+ * arrives after a newer request was made is dropped.
+ */
+void CBossDamageRankingManager::request_config_load(const bool share_with_peers)
+{
+    const auto request_id{++m_config_request_id};
+    const auto loaded_at{static_cast<uint32_t>(get_global_time())};
+
+    DBManager::instance().FuncQuery([this, request_id, loaded_at, share_with_peers](SQLMsg* p_msg)
+        { on_config_loaded(request_id, loaded_at, share_with_peers, p_msg); },
+        boss_config_query);
+}
+
+/**
+ * @brief Build a config snapshot from the result of the boss_dmg_ranking query
+ *
+ * @param p_msg The query result
+ * @return std::optional<BossDamageRankingConfig> The snapshot, or std::nullopt if the query failed
+ */
+std::optional<BossDamageRankingConfig> CBossDamageRankingManager::create_config(SQLMsg* p_msg)
+{
+    if (constexpr uint8_t sql_err_load_data{0U}; nullptr == p_msg || sql_err_load_data != p_msg->uiSQLErrno)
+    {
+        sys_err("CBossDmgRankingManager::create_config - cannot load boss damage ranking data");
+
+        return std::nullopt;
+    }
+
+    if (constexpr uint8_t sql_zero_rows{0U}; sql_zero_rows == p_msg->Get()->uiNumRows)
+    {
+        sys_err("CBossDmgRankingManager::create_config - no boss damage ranking data found");
+
+        return BossDamageRankingConfig{};
+    }
+
+    std::vector<BossDamageRankingBossSettings> boss_settings_vec{};
+    boss_settings_vec.reserve(p_msg->Get()->uiNumRows);
+
+    MYSQL_ROW row{};
+    while (nullptr != (row = mysql_fetch_row(p_msg->Get()->pSQLResult)))
+    {
+        BossDamageRankingBossSettings settings{};
+        str_to_number(settings.mob_vnum, row[0]);
+
+        // NULL leaves the core default
+        if (nullptr != row[1])
+        {
+            uint32_t top_limit{};
+            str_to_number(top_limit, row[1]);
+            settings.top_limit = static_cast<uint8_t>(std::min(top_limit, 254U));
+        }
+
+        if (nullptr != row[2])
+        {
+            uint32_t broadcast_interval{};
+            str_to_number(broadcast_interval, row[2]);
+            settings.broadcast_interval = broadcast_interval;
+        }
+
+        str_to_number(settings.max_participants, row[3]);
+
+        uint32_t track_dot_flags{};
+        str_to_number(track_dot_flags, row[4]);
+        settings.track_dot_flags = 0U != track_dot_flags;
+
+        uint32_t persist_result{};
+        str_to_number(persist_result, row[5]);
+        settings.persist_result = 0U != persist_result;
+
+        boss_settings_vec.emplace_back(settings);
+    }
+
+    return create_config(std::move(boss_settings_vec));
+}
+
+/**
+ * @brief Build a config snapshot from the settings of the ranked bosses
+ *
+ * @param boss_settings_vec The settings of the ranked bosses, in any order
+ * @return BossDamageRankingConfig The snapshot
+ */
+BossDamageRankingConfig CBossDamageRankingManager::create_config(
+    std::vector<BossDamageRankingBossSettings> boss_settings_vec)
+{
+    BossDamageRankingConfig config{};
+
+    std::sort(boss_settings_vec.begin(),
+        boss_settings_vec.end(),
+        [](const BossDamageRankingBossSettings& lhs, const BossDamageRankingBossSettings& rhs)
+        { return lhs.mob_vnum < rhs.mob_vnum; });
+
+    for (const auto& settings: boss_settings_vec) { config.boss_vnum_filter.insert(settings.mob_vnum); }
+
+    config.boss_settings_vec = std::move(boss_settings_vec);
+
+    return config;
+}
+
+/**
+ * @brief Serialize a config snapshot into a HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING packet
+ *
+ * @param config The config snapshot
+ * @param sub_header CONFIG for a reload, RESYNC_CONFIG for the answer to a resync request
+ * @return std::vector<uint8_t> The packet, fixed part and boss settings
+ */
+std::vector<uint8_t> CBossDamageRankingManager::create_config_packet(
+    const BossDamageRankingConfig& config, const EPacketGGBossDamageRankingSubHeaderType sub_header)
+{
+    const auto boss_count{config.boss_settings_vec.size()};
+    const auto row_size{sizeof(SPacketGGBossDamageRankingBossSettings) * boss_count};
+
+    std::vector<uint8_t> packet(sizeof(SPacketGGBossDamageRankingConfig) + row_size);
+    auto* const p_rows{packet.data() + sizeof(SPacketGGBossDamageRankingConfig)};
+
+    for (size_t index{}; index < boss_count; ++index)
+    {
+        const auto& settings{config.boss_settings_vec[index]};
+
+        SPacketGGBossDamageRankingBossSettings row{};
+        row.mob_vnum = settings.mob_vnum;
+        row.top_limit = settings.top_limit.value_or(0U);
+        row.broadcast_interval = settings.broadcast_interval.value_or(0U);
+        row.max_participants = settings.max_participants;
+
+        if (settings.top_limit.has_value())
+        {
+            row.flags |= static_cast<uint8_t>(EBossDamageRankingSettingsFlag::HAS_TOP_LIMIT);
+        }
+
+        if (settings.broadcast_interval.has_value())
+        {
+            row.flags |= static_cast<uint8_t>(EBossDamageRankingSettingsFlag::HAS_BROADCAST_INTERVAL);
+        }
+
+        if (settings.track_dot_flags) { row.flags |= static_cast<uint8_t>(EBossDamageRankingSettingsFlag::TRACK_DOT_FLAGS); }
+
+        if (settings.persist_result) { row.flags |= static_cast<uint8_t>(EBossDamageRankingSettingsFlag::PERSIST_RESULT); }
+
+        std::memcpy(p_rows + index * sizeof(row), &row, sizeof(row));
+    }
+
+    SPacketGGBossDamageRankingConfig header_packet{};
+    header_packet.header = HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING;
+    header_packet.sub_header = static_cast<uint8_t>(sub_header);
+    header_packet.size = static_cast<uint32_t>(row_size);
+    header_packet.checksum = calc_config_checksum(p_rows, row_size);
+    header_packet.boss_count = static_cast<uint32_t>(boss_count);
+    header_packet.loaded_at = config.loaded_at;
+
+    std::memcpy(packet.data(), &header_packet, sizeof(header_packet));
+
+    return packet;
+}
+
+/**
+ * @brief Build the checksum announcement of a config snapshot
+ *
+ * @param config The config snapshot
+ * @return SPacketGGBossDamageRankingConfig The fixed part of its config packet, without the boss settings
+ */
+SPacketGGBossDamageRankingConfig CBossDamageRankingManager::create_config_checksum_packet(
+    const BossDamageRankingConfig& config)
+{
+    const auto config_packet{
+        create_config_packet(config, EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_CHECKSUM)};
+
+    SPacketGGBossDamageRankingConfig header_packet{};
+    std::memcpy(&header_packet, config_packet.data(), sizeof(header_packet));
+    header_packet.size = 0U;
+
+    return header_packet;
+}
+
+/**
+ * @brief Announce the checksum of the newest config snapshot to the other cores
+ *
+ * @param p_desc The peer to announce it to, or nullptr for every peer.
+ *
+ * @details A peer whose snapshot differs and is older asks for a resync; one whose
+ * snapshot is newer answers with its own checksum, so this core asks instead.
+ */
+void CBossDamageRankingManager::send_config_checksum(LPDESC p_desc) const
+{
+    const auto checksum_packet{create_config_checksum_packet(get_latest_config())};
+
+    if (nullptr != p_desc)
+    {
+        p_desc->Packet(&checksum_packet, sizeof(checksum_packet));
+
+        return;
+    }
+
+    P2P_MANAGER::instance().Send(&checksum_packet, sizeof(checksum_packet));
+}
+
+/**
+ * @brief Hash the boss settings of a config packet
+ *
+ * @param p_data The serialized boss settings
+ * @param size The number of bytes
+ * @return uint32_t The FNV-1a hash
+ */
+uint32_t CBossDamageRankingManager::calc_config_checksum(const uint8_t* p_data, const size_t size) noexcept
+{
+    constexpr uint32_t fnv_offset_basis{2166136261U};
+    constexpr uint32_t fnv_prime{16777619U};
+
+    auto checksum{fnv_offset_basis};
+
+    for (size_t index{}; index < size; ++index)
+    {
+        checksum = (checksum ^ p_data[index]) * fnv_prime;
+    }
+
+    return checksum;
+}
+
+/**
+ * @brief Handle a HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING packet of a peer
+ *
+ * @param p_desc The peer descriptor.
+ * @param p_data The packet data.
+ * @param size The number of bytes available.
+ * @return int The number of bytes read past the fixed packet, or -1 if the packet is not complete yet.
+ *
+ * @details A config is applied straight from the packet on the next pulse. A config whose
+ * checksum does not match is dropped and a resync is requested from the sender, once.
+ * A checksum announcement of a newer snapshot also asks for a resync.
+ */
+int CBossDamageRankingManager::recv_p2p_packet(LPDESC p_desc, const char* p_data, const size_t size)
+{
+    SPacketGGBossDamageRankingConfig header_packet{};
+    std::memcpy(&header_packet, p_data, sizeof(header_packet));
+
+    if (size < sizeof(header_packet) + header_packet.size) { return -1; }
+
+    const auto extra_size{static_cast<int>(header_packet.size)};
+    const auto sub_header{static_cast<EPacketGGBossDamageRankingSubHeaderType>(header_packet.sub_header)};
+
+    if (EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RESYNC_REQUEST == sub_header)
+    {
+        const auto packet{create_config_packet(
+            get_latest_config(), EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RESYNC_CONFIG)};
+        p_desc->Packet(packet.data(), static_cast<int>(packet.size()));
+
+        return extra_size;
+    }
+
+    if (EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_CHECKSUM == sub_header)
+    {
+        const auto own_packet{create_config_checksum_packet(get_latest_config())};
+
+        if (own_packet.checksum == header_packet.checksum && own_packet.boss_count == header_packet.boss_count)
+        {
+            return extra_size;
+        }
+
+        // the newer snapshot wins, the checksum only breaks a tie
+        if (const bool is_peer_newer{own_packet.loaded_at != header_packet.loaded_at
+                                         ? own_packet.loaded_at < header_packet.loaded_at
+                                         : own_packet.checksum < header_packet.checksum};
+            !is_peer_newer)
+        {
+            p_desc->Packet(&own_packet, sizeof(own_packet));
+
+            return extra_size;
+        }
+
+        sys_log(0,
+            "CBossDmgRankingManager::recv_p2p_packet - config drifted from a peer (%u bosses loaded at %u, peer %u at %u), resyncing",
+            own_packet.boss_count,
+            own_packet.loaded_at,
+            header_packet.boss_count,
+            header_packet.loaded_at);
+
+        SPacketGGBossDamageRankingConfig resync_packet{};
+        resync_packet.header = HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING;
+        resync_packet.sub_header =
+            static_cast<uint8_t>(EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RESYNC_REQUEST);
+        p_desc->Packet(&resync_packet, sizeof(resync_packet));
+
+        return extra_size;
+    }
+
+    const auto* const p_rows{reinterpret_cast<const uint8_t*>(p_data) + sizeof(header_packet)};
+
+    if (const bool is_valid{header_packet.size == sizeof(SPacketGGBossDamageRankingBossSettings) *
+                                                      static_cast<size_t>(header_packet.boss_count) &&
+                            header_packet.checksum == calc_config_checksum(p_rows, header_packet.size)};
+        !is_valid)
+    {
+        sys_err("CBossDmgRankingManager::recv_p2p_packet - config checksum mismatch, %u bosses in %u bytes",
+            header_packet.boss_count,
+            header_packet.size);
+
+        // a resync answer that is broken too is not asked for again
+        if (EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_CONFIG == sub_header)
+        {
+            SPacketGGBossDamageRankingConfig resync_packet{};
+            resync_packet.header = HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING;
+            resync_packet.sub_header =
+                static_cast<uint8_t>(EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RESYNC_REQUEST);
+            p_desc->Packet(&resync_packet, sizeof(resync_packet));
+        }
+
+        return extra_size;
+    }
+
+    std::vector<BossDamageRankingBossSettings> boss_settings_vec(header_packet.boss_count);
+
+    for (size_t index{}; index < boss_settings_vec.size(); ++index)
+    {
+        SPacketGGBossDamageRankingBossSettings row{};
+        std::memcpy(&row, p_rows + index * sizeof(row), sizeof(row));
+
+        const auto has_flag{[&row](const EBossDamageRankingSettingsFlag flag)
+            { return 0U != (row.flags & static_cast<uint8_t>(flag)); }};
+
+        auto& settings{boss_settings_vec[index]};
+        settings.mob_vnum = row.mob_vnum;
+        settings.max_participants = row.max_participants;
+        settings.track_dot_flags = has_flag(EBossDamageRankingSettingsFlag::TRACK_DOT_FLAGS);
+        settings.persist_result = has_flag(EBossDamageRankingSettingsFlag::PERSIST_RESULT);
+
+        if (has_flag(EBossDamageRankingSettingsFlag::HAS_TOP_LIMIT)) { settings.top_limit = row.top_limit; }
+
+        if (has_flag(EBossDamageRankingSettingsFlag::HAS_BROADCAST_INTERVAL))
+        {
+            settings.broadcast_interval = row.broadcast_interval;
+        }
+    }
+
+    auto config{create_config(std::move(boss_settings_vec))};
+    config.loaded_at = header_packet.loaded_at;
+
+    // the peer's snapshot is newer than any load still on its way
+    ++m_config_request_id;
+    m_pending_config = std::make_shared<const BossDamageRankingConfig>(std::move(config));
+
+    return extra_size;
+}
+
+/**
+ * @brief Keep the snapshot of an asynchronous config load for the next pulse
+ *
+ * @param request_id The ID of the load request.
+ * @param loaded_at The time the load was requested.
+ * @param share_with_peers Whether the snapshot is sent to the other cores.
+ * @param p_msg The query result.
+ */
+void CBossDamageRankingManager::on_config_loaded(
+    const uint32_t request_id, const uint32_t loaded_at, const bool share_with_peers, SQLMsg* p_msg)
+{
+    // a newer load is on its way, its result wins
+    if (request_id != m_config_request_id) { return; }
+
+    auto config{create_config(p_msg)};
+
+    if (std::nullopt == config) { return; }
+
+    config->loaded_at = loaded_at;
+
+    m_pending_config = std::make_shared<const BossDamageRankingConfig>(std::move(config.value()));
+
+    if (!share_with_peers) { return; }
+
+    // the peers apply the snapshot as is instead of all querying the database again
+    const auto packet{
+        create_config_packet(*m_pending_config, EPacketGGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_CONFIG)};
+    P2P_MANAGER::instance().Send(packet.data(), static_cast<int>(packet.size()));
+}
+
+/**
+ * @brief Get the newest config snapshot, published or waiting for the next pulse
+ *
+ * @return const BossDamageRankingConfig& The config snapshot
+ */
+const BossDamageRankingConfig& CBossDamageRankingManager::get_latest_config() const noexcept
+{
+    return nullptr != m_pending_config ? *m_pending_config : *m_config;
+}
+
+/**
+ * @brief Publish a config snapshot and tear down the bosses it no longer ranks
+ *
+ * @param config The new config snapshot.
+ */
+void CBossDamageRankingManager::publish_config(boss_damage_ranking_config_t config)
+{
+    m_config = std::move(config);
+
+    uint32_t removed_count{};
+
+    for (boss_slot_t boss_slot{}; boss_slot < m_boss_info_vec.size(); ++boss_slot)
+    {
+        if (nullptr == m_boss_info_vec[boss_slot]) { continue; }
+
+        if (is_boss_in_ranking(m_boss_info_vec[boss_slot]->get_boss_info()->mob_vnum)) { continue; }
+
+        // the participants get the final ranking, the boss handle goes stale
+        erase_boss_slot(boss_slot, EBossDamageRankingFightEnd::UNRANKED);
+        ++removed_count;
+    }
+
+    sys_log(0,
+        "CBossDamageRankingManager::publish_config - %u ranked vnums, %u bosses no longer ranked",
+        static_cast<uint32_t>(m_config->boss_settings_vec.size()),
+        removed_count);
+}
+
+/**
+ * @brief Retrieve boss information based on boss ID and mob VID.
+ *
+ * @param boss_id_data The boss ID and mob VID to retrieve the information for.
+ * @return std::optional<BossDamageRankingBossInfo*> Optional containing the
+ * boss info if found, otherwise std::nullopt.
+ */
+std::optional<CBossDamageRankingBossData*> CBossDamageRankingManager::get_boss_info(
+    const BossDamageRankingIdData& boss_id_data) const
+{
+    const auto boss_slot{find_boss_slot(boss_id_data)};
+
+    if (std::nullopt == boss_slot) { return std::nullopt; }
+
+    return m_boss_info_vec[boss_slot.value()].get();
+}
+
+/**
+ * @brief Find the slot of a tracked boss through the VID index.
+ *
+ * @param boss_id_data The boss ID and mob VID to look up.
+ * @return std::optional<boss_slot_t> The boss slot, or std::nullopt if the VID is not tracked
+ * or now belongs to another mob vnum.
+ */
+std::optional<CBossDamageRankingManager::boss_slot_t> CBossDamageRankingManager::find_boss_slot(
+    const BossDamageRankingIdData& boss_id_data) const noexcept
+{
+    const auto boss_slot{m_boss_index.find(boss_id_data.mob_vid)};
+
+    if (hashutils::FlatIndex<uint32_t>::npos == boss_slot) { return std::nullopt; }
+
+    const auto* const boss_info_ptr{m_boss_info_vec[boss_slot]->get_boss_info()};
+
+    if (nullptr == boss_info_ptr || !(boss_info_ptr == boss_id_data)) { return std::nullopt; }
+
+    return boss_slot;
+}
+
+/**
+ * @brief Free a boss slot and drop its VID from the index.
+ *
+ * @param boss_slot The slot to free.
+ * @return boss_damage_ranking_boss_data_t The record the slot held
+ */
+CBossDamageRankingManager::boss_damage_ranking_boss_data_t CBossDamageRankingManager::release_boss_slot(
+    const boss_slot_t boss_slot)
+{
+    auto boss_data{std::move(m_boss_info_vec[boss_slot])};
+
+    if (nullptr == boss_data) { return boss_data; }
+
+    if (const auto* const boss_info_ptr{boss_data->get_boss_info()}; nullptr != boss_info_ptr)
+    {
+        m_boss_index.erase(boss_info_ptr->mob_vid);
+    }
+
+    // handles still held by the old boss no longer match the slot
+    ++m_boss_generation_vec[boss_slot];
+    m_free_boss_slot_vec.emplace_back(boss_slot);
+
+    return boss_data;
+}
+
+/**
+ * @brief Resolve a boss handle to its tracker.
+ *
+ * @param boss_handle The handle returned by add_boss_to_list.
+ * @return CBossDamageRankingBossData* The boss data, or nullptr if the handle is unassigned or stale.
+ */
+CBossDamageRankingBossData* CBossDamageRankingManager::resolve_boss(
+    const BossDamageRankingHandle& boss_handle) const noexcept
+{
+    if (boss_handle.slot >= m_boss_generation_vec.size()) { return nullptr; }
+
+    if (m_boss_generation_vec[boss_handle.slot] != boss_handle.generation) { return nullptr; }
+
+    return m_boss_info_vec[boss_handle.slot].get();
+}
+
+/**
+ * @brief Build the handle of a tracked boss from its ID data.
+ *
+ * @param boss_id_data The boss ID and mob VID to look up.
+ * @return BossDamageRankingHandle The boss handle, unassigned if the boss is not tracked.
+ */
+BossDamageRankingHandle CBossDamageRankingManager::get_boss_handle(
+    const BossDamageRankingIdData& boss_id_data) const noexcept
+{
+    const auto boss_slot{find_boss_slot(boss_id_data)};
+
+    if (std::nullopt == boss_slot) { return {}; }
+
+    return {boss_slot.value(), m_boss_generation_vec[boss_slot.value()]};
+}
+
+/**
+ * @brief Check if a boss handle still refers to a tracked boss.
+ *
+ * @param boss_handle The handle returned by add_boss_to_list.
+ * @return bool
+ */
+bool CBossDamageRankingManager::is_boss_tracked(const BossDamageRankingHandle& boss_handle) const noexcept
+{
+    return nullptr != resolve_boss(boss_handle);
+}
+
+/**
+ * @brief Validate character and boss information.
+ *
+ * @param p_character The character pointer.
+ * @param boss_handle The handle of the boss.
+ * @return Optional pair containing boss info and player data if validation succeeds, std::nullopt otherwise.
+ */
+std::optional<CBossDamageRankingManager::validate_data_t> CBossDamageRankingManager::validate_and_get_data(
+    LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle) const
+{
+    if (nullptr == p_character || nullptr == p_character->GetDesc()) { return std::nullopt; }
+
+    auto* const boss_info{resolve_boss(boss_handle)};
+
+    if (nullptr == boss_info) { return std::nullopt; }
+
+    auto* player_data = boss_info->get_player_data();
+
+    if (nullptr == player_data) { return std::nullopt; }
+
+    return std::make_pair(boss_info, player_data);
+}
+
+/**
+ * @brief Find the participant slot of a character, adding it to the damage list if needed.
+ *
+ * @param boss_data The boss data object.
+ * @param player_data The player data object.
+ * @param p_character The character pointer.
+ * @param boss_handle The handle of the boss.
+ * @return std::optional<player_slot_t> The participant slot, or std::nullopt if the character is invalid.
+ *
+ * @details A character that joins the ranking gets the current ranking right away instead of
+ * waiting for the next broadcast. A participant coming back with a new character is attached
+ * to it again. A participant that joined or left a party or guild since its last hit is moved
+ * to its current groups.
+ */
+std::optional<player_slot_t> CBossDamageRankingManager::ensure_player_in_ranking(CBossDamageRankingBossData* boss_data,
+    CBossDamageRankingPlayerData* player_data,
+    LPCHARACTER p_character,
+    const BossDamageRankingHandle& boss_handle)
+{
+    // the index is only probed again once the fight is full
+    if (const auto max_participants{boss_data->get_policy().max_participants};
+        0U != max_participants && player_data->get_player_count() >= max_participants &&
+        !player_data->is_player_in_ranking(p_character->GetPlayerID()))
+    {
+        return std::nullopt;
+    }
+
+    const auto player_slot{player_data->find_or_add_player(p_character)};
+
+    if (std::nullopt == player_slot) { return std::nullopt; }
+
+    const auto& [slot, inserted]{player_slot.value()};
+
+    if (const auto group_ids{get_group_ids(p_character)}; !player_data->has_groups(slot, group_ids))
+    {
+        player_data->set_groups(slot, create_group_profiles(p_character, group_ids));
+    }
+
+    if (inserted || player_data->attach_character(slot, p_character))
+    {
+        add_participant_ref(p_character->GetPlayerID(), boss_handle, slot);
+    }
+
+    if (inserted)
+    {
+        const auto& boss_info{*boss_data->get_boss_info()};
+
+        // the player's ranking version stays 0, so the next broadcast sends a full ranking again
+        send_ranking_to_player(p_character,
+            create_ranking_packet(boss_info.mob_vid,
+                boss_data->get_ranking_version(),
+                create_ranking_info_vector(*player_data, boss_info),
+                create_group_ranking_vector(*player_data, boss_info)),
+            create_damage_info(player_data->get_damage(slot),
+                boss_info,
+                player_data->get_player_rank(slot),
+                player_data->get_player_count(),
+                player_data->get_dps(slot, get_dword_time())));
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Remember that a character is cached as a participant of a boss.
+ *
+ * @param player_id The player ID of the character.
+ * @param boss_handle The handle of the boss.
+ * @param player_slot The participant slot of the character.
+ *
+ * @details References to bosses that are gone are dropped on the way.
+ */
+void CBossDamageRankingManager::add_participant_ref(
+    const uint32_t player_id, const BossDamageRankingHandle& boss_handle, const player_slot_t player_slot)
+{
+    auto& participant_ref_vec{m_participant_ref_map[player_id]};
+
+    const auto stale_pred_func{[this](const ParticipantRef& participant_ref)
+        { return nullptr == resolve_boss(participant_ref.boss_handle); }};
+
+#if __cplusplus >= 202002L
+    std::erase_if(participant_ref_vec, stale_pred_func);
+#else
+    participant_ref_vec.erase(std::remove_if(participant_ref_vec.begin(), participant_ref_vec.end(), stale_pred_func),
+        participant_ref_vec.end());
+#endif
+
+    participant_ref_vec.push_back({boss_handle, player_slot});
+}
+
+/**
+ * @brief Drop a destroyed character from every ranking it is cached in.
+ *
+ * @param p_character The character being destroyed.
+ *
+ * @details Called from CHARACTER::Destroy, so logouts, warps and disconnects all
+ * end here. The participants keep their damage and are attached again when the
+ * player hits the boss with a new character.
+ */
+void CBossDamageRankingManager::on_character_destroy(LPCHARACTER p_character)
+{
+    if (nullptr == p_character) { return; }
+
+    if (nullptr != mp_worker)
+    {
+        const auto recipient_slot{p_character->GetBossDamageRankingRecipientSlot()};
+
+        if (no_recipient_slot == recipient_slot) { return; }
+
+        BossDamageRankingEvent event{};
+        event.type = EBossDamageRankingEventType::PLAYER_OFFLINE;
+        event.player_id = p_character->GetPlayerID();
+        mp_worker->push_event(event);
+
+        // dispatches still naming the slot no longer find this character
+        m_recipient_vec[recipient_slot] = nullptr;
+        m_free_recipient_slot_vec.emplace_back(recipient_slot);
+        p_character->SetBossDamageRankingRecipientSlot(no_recipient_slot);
+        return;
+    }
+
+    const auto participant_ref_iter{m_participant_ref_map.find(p_character->GetPlayerID())};
+
+    if (participant_ref_iter == m_participant_ref_map.end()) { return; }
+
+    for (const auto& participant_ref: participant_ref_iter->second)
+    {
+        auto* const boss_data{resolve_boss(participant_ref.boss_handle)};
+
+        if (nullptr == boss_data) { continue; }
+
+        boss_data->get_player_data()->detach_character(participant_ref.player_slot, p_character);
+    }
+
+    m_participant_ref_map.erase(participant_ref_iter);
+}
+
+/**
+ * @brief Add player to damage list.
+ *
+ * @param p_character
+ * @param boss_id_data
+ */
+void CBossDamageRankingManager::add_player_to_list(
+    LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data)
+{
+    add_player_to_list(p_character, get_boss_handle(boss_id_data));
+}
+
+/**
+ * @brief Add player to damage list.
+ *
+ * @param p_character
+ * @param boss_handle The handle of the boss.
+ */
+void CBossDamageRankingManager::add_player_to_list(
+    LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle)
+{
+    if (nullptr != mp_worker)
+    {
+        queue_damage_event(p_character, boss_handle, 0U);
+        return;
+    }
+
+    const auto validation_result{validate_and_get_data(p_character, boss_handle)};
+
+    if (!validation_result.has_value()) { return; }
+
+    auto* boss_info{validation_result->first};
+    auto* player_data{validation_result->second};
+
+    if (std::nullopt == ensure_player_in_ranking(boss_info, player_data, p_character, boss_handle)) { return; }
+
+    mark_boss_dirty(boss_info, boss_handle);
+}
+
+/**
+ * @brief Process damage dealt to a boss.
+ *
+ * @param p_character The character ptr.
+ * @param boss_id_data The boss ID and mob VID to identify the boss.
+ * @param damage The amount of damage dealt to the boss.
+ */
+void CBossDamageRankingManager::damage_process(
+    LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data, uint64_t damage)
+{
+    damage_process(p_character, get_boss_handle(boss_id_data), damage);
+}
+
+/**
+ * @brief Process damage dealt to a boss.
+ *
+ * @param p_character The character ptr.
+ * @param boss_handle The handle of the boss.
+ * @param damage The amount of damage dealt to the boss.
+ */
+void CBossDamageRankingManager::damage_process(
+    LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle, uint64_t damage)
+{
+    const perfutils::SampledCallTimer call_timer{m_call_stats.damage_process};
+    perfutils::TraceSpan trace_span{m_flight_recorder, "damage_process"};
+
+    if (nullptr != mp_worker)
+    {
+        queue_damage_event(p_character, boss_handle, damage);
+        return;
+    }
+
+    const auto validation_result = validate_and_get_data(p_character, boss_handle);
+
+    if (!validation_result.has_value()) { return; }
+
+    auto* boss_info{validation_result->first};
+    auto* player_data{validation_result->second};
+
+    trace_span.set_boss(boss_info->get_boss_info()->mob_vid, player_data->get_player_count());
+
+    const auto player_slot{ensure_player_in_ranking(boss_info, player_data, p_character, boss_handle)};
+
+    if (std::nullopt == player_slot) { return; }
+
+    const auto now{get_dword_time()};
+
+    player_data->add_damage(player_slot.value(), damage, now);
+
+    if (auto& event_log{boss_info->get_event_log()}; event_log.is_enabled()) [[unlikely]]
+    {
+        event_log.record(now, player_slot.value(), damage, 0U);
+    }
+
+    mark_boss_dirty(boss_info, boss_handle);
+}
+
+/**
+ * @brief Set a bad affect flag for a character in the damage ranking of a boss.
+ *
+ * @param boss_id_data The boss ID and mob VID to identify the boss.
+ * @param player_id The character ID to set the flag for.
+ * @param type The bad affect flag to be set.
+ */
+void CBossDamageRankingManager::set_bad_affect(
+    const BossDamageRankingIdData& boss_id_data, uint32_t player_id, BadAffectType type)
+{
+    set_bad_affect(get_boss_handle(boss_id_data), player_id, type);
+}
+
+/**
+ * @brief Set a bad affect flag for a character in the damage ranking of a boss.
+ *
+ * @param boss_handle The handle of the boss.
+ * @param player_id The character ID to set the flag for.
+ * @param type The bad affect flag to be set.
+ */
+void CBossDamageRankingManager::set_bad_affect(
+    const BossDamageRankingHandle& boss_handle, uint32_t player_id, BadAffectType type)
+{
+    const perfutils::SampledCallTimer call_timer{m_call_stats.set_bad_affect};
+
+    auto* const boss_info{resolve_boss(boss_handle)};
+
+    if (nullptr == boss_info || !boss_info->get_policy().track_dot_flags) { return; }
+
+    if (nullptr != mp_worker)
+    {
+        BossDamageRankingEvent event{};
+        event.type = EBossDamageRankingEventType::BAD_AFFECT;
+        event.flags = static_cast<uint8_t>(type);
+        event.player_id = player_id;
+        event.boss_handle = boss_handle;
+        mp_worker->push_event(event);
+        return;
+    }
+
+    auto* const player_data{boss_info->get_player_data()};
+
+    const auto player_slot{player_data->set_bad_affect_flag(player_id, type)};
+
+    if (auto& event_log{boss_info->get_event_log()}; event_log.is_enabled() && player_slot.has_value()) [[unlikely]]
+    {
+        event_log.record(get_dword_time(), player_slot.value(), 0U, static_cast<uint8_t>(type));
+    }
+
+    mark_boss_dirty(boss_info, boss_handle);
+}
+
+/**
+ * @brief Queue a hit of a character for the worker thread, with its profile on its first hit.
+ *
+ * @param p_character The character pointer.
+ * @param boss_handle The handle of the boss.
+ * @param damage The amount of damage dealt to the boss, 0 to only join the ranking.
+ *
+ * @details The worker never reads a character, so the name and race it shows in the
+ * rankings are sent once per character, before its first hit, and again with its new
+ * groups whenever it joined or left a party or guild.
+ */
+void CBossDamageRankingManager::queue_damage_event(
+    LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle, const uint64_t damage)
+{
+    if (nullptr == p_character || nullptr == p_character->GetDesc() || nullptr == resolve_boss(boss_handle))
+    {
+        return;
+    }
+
+    if (const auto group_ids{get_group_ids(p_character)};
+        no_recipient_slot == p_character->GetBossDamageRankingRecipientSlot() ||
+        get_group_key(group_ids) != p_character->GetBossDamageRankingGroupKey())
+    {
+        queue_online_profile(p_character, group_ids);
+    }
+
+    BossDamageRankingEvent event{};
+    event.type = EBossDamageRankingEventType::DAMAGE;
+    event.player_id = p_character->GetPlayerID();
+    event.boss_handle = boss_handle;
+    event.amount = damage;
+    mp_worker->push_event(event);
+}
+
+/**
+ * @brief Queue the profile of a character for the worker thread, with its current groups.
+ *
+ * @param p_character The character pointer.
+ * @param group_ids The IDs returned by get_group_ids.
+ *
+ * @details The first profile of a character takes a slot in the recipient table, which the
+ * worker names in its dispatches, so they reach the character without a PID lookup.
+ */
+void CBossDamageRankingManager::queue_online_profile(
+    LPCHARACTER p_character, const boss_damage_ranking_group_ids_t& group_ids)
+{
+    if (no_recipient_slot == p_character->GetBossDamageRankingRecipientSlot())
+    {
+        uint32_t recipient_slot{};
+
+        if (m_free_recipient_slot_vec.empty())
+        {
+            recipient_slot = static_cast<uint32_t>(m_recipient_vec.size());
+            m_recipient_vec.emplace_back(p_character);
+        }
+        else
+        {
+            recipient_slot = m_free_recipient_slot_vec.back();
+            m_free_recipient_slot_vec.pop_back();
+            m_recipient_vec[recipient_slot] = p_character;
+        }
+
+        p_character->SetBossDamageRankingRecipientSlot(recipient_slot);
+    }
+
+    BossDamageRankingOnlineProfile online_profile{};
+    auto& profile{online_profile.profile};
+    strncpy(profile.player_name.data(), p_character->GetName(), profile.player_name.size() - 1);
+    profile.race = static_cast<uint8_t>(p_character->GetRaceNum());
+    online_profile.group_profiles = create_group_profiles(p_character, group_ids);
+    online_profile.recipient_slot = p_character->GetBossDamageRankingRecipientSlot();
+
+    mp_worker->push_player_online(p_character->GetPlayerID(), online_profile);
+    p_character->SetBossDamageRankingGroupKey(get_group_key(group_ids));
+}
+
+/**
+ * @brief Move a character into its current party and guild in every ranking it takes part in.
+ *
+ * @param p_character The character that joined or left a party or guild.
+ *
+ * @details Called from CHARACTER::SetParty and CHARACTER::SetGuild, so the member counts
+ * follow at once instead of on the member's next hit; a party whose leader changed is
+ * renamed on the way. The damage dealt so far stays with the groups the character left.
+ */
+void CBossDamageRankingManager::on_group_changed(LPCHARACTER p_character)
+{
+    if (nullptr == p_character || !p_character->IsPC()) { return; }
+
+    const auto group_ids{get_group_ids(p_character)};
+
+    if (nullptr != mp_worker)
+    {
+        // a character that never hit a ranked boss has nothing to move
+        if (no_recipient_slot != p_character->GetBossDamageRankingRecipientSlot())
+        {
+            queue_online_profile(p_character, group_ids);
+        }
+
+        return;
+    }
+
+    const auto participant_ref_iter{m_participant_ref_map.find(p_character->GetPlayerID())};
+
+    if (participant_ref_iter == m_participant_ref_map.end()) { return; }
+
+    const auto group_profiles{create_group_profiles(p_character, group_ids)};
+
+    for (const auto& participant_ref: participant_ref_iter->second)
+    {
+        auto* const boss_data{resolve_boss(participant_ref.boss_handle)};
+
+        if (nullptr == boss_data) { continue; }
+
+        if (boss_data->get_player_data()->set_groups(participant_ref.player_slot, group_profiles))
+        {
+            mark_boss_dirty(boss_data, participant_ref.boss_handle);
+        }
+    }
+}
+
+/**
+ * @brief Send the rankings prepared by the worker thread and persist the bosses it gave back.
+ *
+ * @param send_rankings False to drop the rankings, when shutting down
+ *
+ * @details Recipients are read from the recipient table by the slot the worker names: a
+ * player that logged out since the worker prepared the ranking left an empty slot, or one
+ * already taken by another player, and is skipped.
+ */
+void CBossDamageRankingManager::dispatch_worker_results(const bool send_rankings)
+{
+    BossDamageRankingDispatch dispatch{};
+
+    while (mp_worker->pop_dispatch(dispatch))
+    {
+        if (nullptr != dispatch.p_retired_boss)
+        {
+            // bosses come back in erase order, so this is the front one
+            const auto retiring_iter{std::find_if(m_retiring_boss_deque.begin(),
+                m_retiring_boss_deque.end(),
+                [&dispatch](const RetiringBoss& retiring_boss)
+                { return retiring_boss.p_boss_data.get() == dispatch.p_retired_boss; })};
+
+            if (m_retiring_boss_deque.end() == retiring_iter) { continue; }
+
+            persist_fight(retiring_iter->p_boss_data.get(), retiring_iter->fight_end);
+            write_event_log(retiring_iter->p_boss_data.get(), retiring_iter->fight_end);
+            m_retiring_boss_deque.erase(retiring_iter);
+            continue;
+        }
+
+        if (!send_rankings) { continue; }
+
+        const perfutils::SampledCallTimer call_timer{m_call_stats.send_rankings, 1U};
+
+        if (dispatch.is_broadcast)
+        {
+            ++m_broadcast_stats.broadcasts;
+            m_broadcast_stats.recipients += dispatch.recipient_vec.size();
+        }
+
+        for (const auto& recipient: dispatch.recipient_vec)
+        {
+            if (recipient.recipient_slot >= m_recipient_vec.size()) { continue; }
+
+            auto* const p_character{m_recipient_vec[recipient.recipient_slot]};
+
+            if (nullptr == p_character || recipient.player_id != p_character->GetPlayerID() ||
+                nullptr == p_character->GetDesc())
+            {
+                continue;
+            }
+
+            const bool has_base_version{
+                0U != dispatch.base_version && recipient.ranking_version == dispatch.base_version};
+
+            send_ranking_to_player(
+                p_character, has_base_version ? dispatch.delta_packet : dispatch.full_packet, recipient.damage_info);
+        }
+    }
+}
+
+/**
+ * @brief Wait until the worker applied every queued event and send what it prepared
+ *
+ * @details Game thread only, for tools that read the stats such as the bench; the
+ * game never waits for the worker.
+ */
+void CBossDamageRankingManager::wait_for_worker()
+{
+    if (nullptr == mp_worker) { return; }
+
+    while (!mp_worker->flush_pending_events() || mp_worker->get_applied_event_count() < mp_worker->get_event_count())
+    {
+        dispatch_worker_results(true);
+        std::this_thread::yield();
+    }
+
+    dispatch_worker_results(true);
+}
+
+/**
+ * @brief Stop the worker thread once it applied every queued event
+ *
+ * @details The erased bosses it still held come back and are persisted; the
+ * rankings it prepared meanwhile are dropped.
+ */
+void CBossDamageRankingManager::stop_worker()
+{
+    if (nullptr == mp_worker) { return; }
+
+    // the events kept aside give the erased bosses back too
+    while (!mp_worker->flush_pending_events())
+    {
+        dispatch_worker_results(false);
+        std::this_thread::yield();
+    }
+
+    mp_worker->request_stop();
+
+    while (mp_worker->is_running())
+    {
+        dispatch_worker_results(false);
+        std::this_thread::yield();
+    }
+
+    dispatch_worker_results(false);
+    mp_worker.reset();
+}
+
+/**
+ * @brief Queue a boss for the next ranking broadcast.
+ *
+ * @param boss_data The boss data object.
+ * @param boss_handle The handle of the boss.
+ */
+void CBossDamageRankingManager::mark_boss_dirty(
+    CBossDamageRankingBossData* boss_data, const BossDamageRankingHandle& boss_handle)
+{
+    if (boss_data->mark_dirty()) { m_dirty_boss_vec.emplace_back(boss_handle); }
+}
+
+/**
+ * @brief Broadcast the rankings of the bosses that changed since their last broadcast.
+ *
+ * @details A boss is broadcast at most once per broadcast interval; bosses still inside
+ * their interval stay queued for a later pulse.
+ */
+void CBossDamageRankingManager::flush_rankings()
+{
+    if (m_dirty_boss_vec.empty()) { return; }
+
+    const perfutils::TraceSpan trace_span{m_flight_recorder, "flush_rankings"};
+
+    const auto now{get_dword_time()};
+
+    const auto flush_pred_func{[this, now](const BossDamageRankingHandle& boss_handle)
+        {
+            auto* const boss_info{resolve_boss(boss_handle)};
+
+            if (nullptr == boss_info || !boss_info->is_dirty()) { return true; }
+
+            if (!boss_info->can_broadcast(now, boss_info->get_policy().broadcast_interval)) { return false; }
+
+            send_rankings_to_players(boss_info);
+            boss_info->set_broadcasted(now);
+
+            return true;
+        }};
+
+#if __cplusplus >= 202002L
+    std::erase_if(m_dirty_boss_vec, flush_pred_func);
+#else
+    m_dirty_boss_vec.erase(
+        std::remove_if(m_dirty_boss_vec.begin(), m_dirty_boss_vec.end(), flush_pred_func), m_dirty_boss_vec.end());
+#endif
+}
+
+/**
+ * @brief Destroy the CBossDamageRankingManager object, queueing the pending fight results
+ */
+CBossDamageRankingManager::~CBossDamageRankingManager()
+{
+    stop_worker();
+    flush_fight_results();
+}
+
+/**
+ * @brief Run the periodic work of the manager, called from the game heartbeat.
+ *
+ * @param pulse The current game pulse.
+ */
+void CBossDamageRankingManager::update(const int pulse)
+{
+    if (nullptr != m_pending_config) { publish_config(std::move(m_pending_config)); }
+
+    if (nullptr != mp_worker)
+    {
+        // the worker serializes the rankings when it reaches this pulse, with this pulse's time
+        BossDamageRankingEvent event{};
+        event.type = EBossDamageRankingEventType::PULSE;
+        mp_worker->push_event(event);
+
+        dispatch_worker_results(true);
+    }
+    else { flush_rankings(); }
+
+    if (0 == pulse % PASSES_PER_SEC(boss_reap_interval_sec)) { reap_bosses(); }
+
+    if (0 == pulse % PASSES_PER_SEC(fight_result_flush_interval_sec)) { flush_fight_results(); }
+
+    // a core that booted or reconnected after a reload finds out here at the latest
+    if (0 == pulse % PASSES_PER_SEC(config_checksum_interval_sec)) { send_config_checksum(nullptr); }
+
+    if (0U != m_stats_log_interval && 0 == pulse % PASSES_PER_SEC(static_cast<int>(m_stats_log_interval)))
+    {
+        for (const auto& line: create_stats_report()) { sys_log(0, "BOSS_DMG_STATS: %s", line.c_str()); }
+    }
+}
+
+/**
+ * @brief Erase the tracked bosses whose mob no longer exists.
+ *
+ * @details Safety net for the destroy paths that do not reach the registry: a boss
+ * is reaped when its VID no longer resolves to a living mob of the same vnum.
+ */
+void CBossDamageRankingManager::reap_bosses()
+{
+    uint32_t reaped_count{};
+
+    for (boss_slot_t boss_slot{}; boss_slot < m_boss_info_vec.size(); ++boss_slot)
+    {
+        if (nullptr == m_boss_info_vec[boss_slot]) { continue; }
+
+        const auto& boss_info{*m_boss_info_vec[boss_slot]->get_boss_info()};
+        auto* const p_boss{CHARACTER_MANAGER::instance().Find(boss_info.mob_vid)};
+
+        if (nullptr != p_boss && !p_boss->IsDead() && p_boss->GetRaceNum() == boss_info.mob_vnum) { continue; }
+
+        erase_boss_slot(boss_slot, EBossDamageRankingFightEnd::REAPED);
+        ++reaped_count;
+    }
+
+    if (0U != reaped_count)
+    {
+        sys_log(0,
+            "CBossDamageRankingManager::reap_bosses - reaped %u leaked bosses, %u live, %llu reaped in total",
+            reaped_count,
+            static_cast<uint32_t>(m_boss_index.size()),
+            static_cast<unsigned long long>(m_reaped_boss_count));
+    }
+}
+
+/**
+ * @brief Add a boss to the list of bosses tracked by the damage ranking
+ * manager.
+ *
+ * @param boss_data The boss information to add to the list.
+ * @return BossDamageRankingHandle The handle to keep on the boss character, unassigned if the
+ * boss is not ranked.
+ */
+BossDamageRankingHandle CBossDamageRankingManager::add_boss_to_list(const BossDamageRankingBossInfo& boss_data)
+{
+    if (!is_boss_in_ranking(boss_data.mob_vnum)) { return {}; }
+
+    const auto* const boss_settings{m_config->find_boss_settings(boss_data.mob_vnum)};
+
+    if (nullptr == boss_settings) { return {}; }
+
+    // a VID is only reused once its mob is gone, so an indexed entry with the same VID is stale
+    if (const auto stale_slot{m_boss_index.find(boss_data.mob_vid)}; hashutils::FlatIndex<uint32_t>::npos != stale_slot)
+    {
+        erase_boss_slot(stale_slot, EBossDamageRankingFightEnd::REAPED);
+    }
+
+    auto boss_info{boss_data};
+    boss_info.spawn_time = static_cast<uint32_t>(get_global_time());
+    boss_info.damage_percent_reciprocal = calc_damage_percent_reciprocal(boss_data.max_hp);
+
+    // the worker grows the arenas on its own thread, so they draw from the thread-safe heap directly
+    auto p_boss_data{m_boss_pool.create(boss_info,
+        boss_settings->make_policy(m_top_limit, m_broadcast_interval),
+        nullptr != mp_worker ? std::pmr::new_delete_resource() : &m_arena_upstream,
+        m_event_log_dir.empty() ? 0U : m_event_log_capacity)};
+
+    boss_slot_t boss_slot{};
+
+    if (m_free_boss_slot_vec.empty())
+    {
+        boss_slot = static_cast<boss_slot_t>(m_boss_info_vec.size());
+        m_boss_info_vec.emplace_back(std::move(p_boss_data));
+        // generation 0 is never handed out, so a zeroed handle cannot match a fresh slot
+        m_boss_generation_vec.emplace_back(1U);
+    }
+    else
+    {
+        boss_slot = m_free_boss_slot_vec.back();
+        m_free_boss_slot_vec.pop_back();
+        m_boss_info_vec[boss_slot] = std::move(p_boss_data);
+    }
+
+    m_boss_index.find_or_insert(boss_data.mob_vid, boss_slot);
+
+    const BossDamageRankingHandle boss_handle{boss_slot, m_boss_generation_vec[boss_slot]};
+
+    if (nullptr != mp_worker)
+    {
+        // the record stays owned here, the worker only uses it until the boss is erased
+        BossDamageRankingEvent event{};
+        event.type = EBossDamageRankingEventType::ADD_BOSS;
+        event.boss_handle = boss_handle;
+        event.p_boss_data = m_boss_info_vec[boss_slot].get();
+        mp_worker->push_event(event);
+    }
+
+    return boss_handle;
+}
+
+/**
+ * @brief Erase a boss from the list of bosses tracked by the damage ranking
+ * manager.
+ *
+ * @param boss_id_data The boss ID and mob VID to identify the boss to be
+ * erased.
+ * @param fight_end Why the fight ended, stored with the fight result.
+ */
+void CBossDamageRankingManager::erase_boss_from_list(
+    const BossDamageRankingIdData& boss_id_data, const EBossDamageRankingFightEnd fight_end)
+{
+    erase_boss_from_list(get_boss_handle(boss_id_data), fight_end);
+}
+
+/**
+ * @brief Erase a boss from the list of bosses tracked by the damage ranking
+ * manager.
+ *
+ * @param boss_handle The handle of the boss to be erased.
+ * @param fight_end Why the fight ended, stored with the fight result.
+ */
+void CBossDamageRankingManager::erase_boss_from_list(
+    const BossDamageRankingHandle& boss_handle, const EBossDamageRankingFightEnd fight_end)
+{
+    if (nullptr == resolve_boss(boss_handle)) { return; }
+
+    erase_boss_slot(boss_handle.slot, fight_end);
+}
+
+/**
+ * @brief Erase every tracked boss spawned on a map.
+ *
+ * @param map_index The index of the map being torn down.
+ */
+void CBossDamageRankingManager::erase_bosses_on_map(const long map_index)
+{
+    for (boss_slot_t boss_slot{}; boss_slot < m_boss_info_vec.size(); ++boss_slot)
+    {
+        if (nullptr == m_boss_info_vec[boss_slot]) { continue; }
+
+        if (m_boss_info_vec[boss_slot]->get_boss_info()->map_index != map_index) { continue; }
+
+        erase_boss_slot(boss_slot, EBossDamageRankingFightEnd::MAP_CLOSED);
+    }
+}
+
+/**
+ * @brief Send the final ranking of a tracked boss if needed, persist the fight and free its slot.
+ *
+ * @param boss_slot The slot of a tracked boss.
+ * @param fight_end Why the fight ended.
+ */
+void CBossDamageRankingManager::erase_boss_slot(const boss_slot_t boss_slot, const EBossDamageRankingFightEnd fight_end)
+{
+    if (EBossDamageRankingFightEnd::REAPED == fight_end) { ++m_reaped_boss_count; }
+    else { ++m_erased_boss_count; }
+
+    if (nullptr != mp_worker)
+    {
+        // the worker sends the final ranking, then gives the record back to be persisted and freed
+        BossDamageRankingEvent event{};
+        event.type = EBossDamageRankingEventType::ERASE_BOSS;
+        event.flags = static_cast<uint8_t>(fight_end);
+        event.boss_handle = {boss_slot, m_boss_generation_vec[boss_slot]};
+        mp_worker->push_event(event);
+
+        m_retiring_boss_deque.push_back({release_boss_slot(boss_slot), fight_end});
+        return;
+    }
+
+    auto* const boss_info{m_boss_info_vec[boss_slot].get()};
+
+    const perfutils::TraceSpan trace_span{m_flight_recorder,
+        "erase_boss",
+        boss_info->get_boss_info()->mob_vid,
+        static_cast<uint32_t>(boss_info->get_player_data()->get_player_count())};
+
+    // the final ranking is sent right away, whatever the broadcast interval
+    if (boss_info->is_dirty()) { send_rankings_to_players(boss_info); }
+
+    persist_fight(boss_info, fight_end);
+    write_event_log(boss_info, fight_end);
+    release_boss_slot(boss_slot);
+}
+
+/**
+ * @brief Queue the result of a finished fight for the next batched write.
+ *
+ * @param boss_data The boss data object.
+ * @param fight_end Why the fight ended.
+ *
+ * @details One row for the fight and one per participant; fights nobody damaged are skipped.
+ */
+void CBossDamageRankingManager::persist_fight(
+    CBossDamageRankingBossData* boss_data, const EBossDamageRankingFightEnd fight_end)
+{
+    const auto& boss_info{*boss_data->get_boss_info()};
+    const auto* const player_data{boss_data->get_player_data()};
+    const auto participant_count{player_data->get_player_count()};
+
+    if (0U == participant_count || !boss_data->get_policy().persist_result) { return; }
+
+    // the fight key, shared by the fight row and its participant rows
+    char key[64]{};
+    snprintf(key,
+        sizeof(key),
+        "%u,%ld,%u,%u",
+        static_cast<uint32_t>(g_bChannel),
+        boss_info.map_index,
+        boss_info.mob_vid,
+        boss_info.spawn_time);
+
+    char row[192]{};
+    const auto fight_row_length{snprintf(row,
+        sizeof(row),
+        "(%s,%u,%u,%u,%llu,%u)",
+        key,
+        boss_info.mob_vnum,
+        static_cast<uint32_t>(get_global_time()),
+        static_cast<uint32_t>(fight_end),
+        static_cast<unsigned long long>(boss_info.max_hp),
+        static_cast<uint32_t>(participant_count))};
+    m_fight_insert.add_row({row, static_cast<size_t>(fight_row_length)});
+
+    const auto& player_id_vec{player_data->get_player_ids()};
+
+    for (player_slot_t player_slot{}; player_slot < participant_count; ++player_slot)
+    {
+        const auto damage{player_data->get_damage(player_slot)};
+
+        const auto participant_row_length{snprintf(row,
+            sizeof(row),
+            "(%s,%u,%llu,%u,%u)",
+            key,
+            player_id_vec[player_slot],
+            static_cast<unsigned long long>(damage),
+            static_cast<uint32_t>(calc_damage_percent(damage, boss_info)),
+            static_cast<uint32_t>(player_data->get_bad_affect_flag(player_slot)))};
+        m_participant_insert.add_row({row, static_cast<size_t>(participant_row_length)});
+    }
+}
+
+/**
+ * @brief Write the event log of a killed boss to the event log directory.
+ *
+ * @param boss_data The boss data object.
+ * @param fight_end Why the fight ended.
+ *
+ * @details Only kills are written; a fight without events writes nothing.
+ */
+void CBossDamageRankingManager::write_event_log(
+    CBossDamageRankingBossData* boss_data, const EBossDamageRankingFightEnd fight_end) const
+{
+    const auto& event_log{boss_data->get_event_log()};
+
+    if (EBossDamageRankingFightEnd::KILLED != fight_end || 0U == event_log.get_event_count()) { return; }
+
+    const auto& boss_info{*boss_data->get_boss_info()};
+    const auto* const player_data{boss_data->get_player_data()};
+    const auto participant_count{player_data->get_player_count()};
+
+    BossDamageRankingLogHeader header{};
+    std::memcpy(header.magic, event_log_magic, sizeof(header.magic));
+    header.version = event_log_version;
+    header.fight_end = static_cast<uint8_t>(fight_end);
+    header.mob_vnum = boss_info.mob_vnum;
+    header.mob_vid = boss_info.mob_vid;
+    header.map_index = static_cast<int32_t>(boss_info.map_index);
+    header.spawn_time = boss_info.spawn_time;
+    header.duration_ms = get_dword_time() - event_log.get_start_ms();
+    header.participant_count = static_cast<uint32_t>(participant_count);
+    header.event_count = static_cast<uint32_t>(event_log.get_event_count());
+    header.max_hp = static_cast<uint64_t>(boss_info.max_hp);
+    header.dropped_event_count = event_log.get_dropped_count();
+
+    static_assert(sizeof(BossDamageRankingLogParticipant::player_name) >= sizeof(BossDamageRankingPlayerProfile::player_name));
+
+    std::vector<BossDamageRankingLogParticipant> participant_vec(participant_count);
+    const auto& player_id_vec{player_data->get_player_ids()};
+
+    for (player_slot_t player_slot{}; player_slot < participant_count; ++player_slot)
+    {
+        auto& participant{participant_vec[player_slot]};
+        const auto& profile{player_data->get_player_profile(player_slot)};
+
+        participant.damage = player_data->get_damage(player_slot);
+        participant.player_id = player_id_vec[player_slot];
+        participant.race = profile.race;
+        participant.bad_affect_flag = player_data->get_bad_affect_flag(player_slot);
+        std::memcpy(participant.player_name, profile.player_name.data(), profile.player_name.size());
+    }
+
+    // named after the fight key of boss_dmg_ranking_fight
+    char file_name[64]{};
+    snprintf(file_name,
+        sizeof(file_name),
+        "/%u_%ld_%u_%u%s",
+        static_cast<uint32_t>(g_bChannel),
+        boss_info.map_index,
+        boss_info.mob_vid,
+        boss_info.spawn_time,
+        event_log_extension);
+
+    if (!write_event_log_file(m_event_log_dir + file_name, header, participant_vec, event_log))
+    {
+        sys_err("CBossDmgRankingManager::write_event_log - cannot write %s%s", m_event_log_dir.c_str(), file_name);
+    }
+}
+
+/**
+ * @brief Queue the pending fight result statements on the asynchronous DB queue.
+ */
+void CBossDamageRankingManager::flush_fight_results()
+{
+    m_fight_insert.flush();
+    m_participant_insert.flush();
+}
+
+/**
+ * @brief Get the counters of the boss registry
+ *
+ * @return BossDamageRankingRegistryStats The registry counters
+ */
+BossDamageRankingRegistryStats CBossDamageRankingManager::get_registry_stats() const noexcept
+{
+    return {m_boss_index.size(), m_erased_boss_count, m_reaped_boss_count};
+}
+
+/**
+ * @brief Get the counters of the ranking broadcasts
+ *
+ * @return const BossDamageRankingBroadcastStats& The broadcast counters
+ */
+const BossDamageRankingBroadcastStats& CBossDamageRankingManager::get_broadcast_stats() const noexcept
+{
+    return m_broadcast_stats;
+}
+
+/**
+ * @brief Get the call counters and sampled latencies of the hot paths
+ *
+ * @return const BossDamageRankingCallStats& The call counters
+ */
+const BossDamageRankingCallStats& CBossDamageRankingManager::get_call_stats() const noexcept { return m_call_stats; }
+
+/**
+ * @brief Reset the broadcast and call counters
+ */
+void CBossDamageRankingManager::reset_stats() noexcept
 {
-    return CBossDamageRankingManager::instance();
+    m_broadcast_stats = {};
+    m_call_stats = {};
 }
 
 /**
- * @brief Initialize the boss damage ranking manager
+ * @brief Format every counter of the manager as text lines, for a GM or the syslog
+ *
+ * @return std::vector<std::string> The report lines
  */
-void CBossDamageRankingManager::initialize() noexcept
+std::vector<std::string> CBossDamageRankingManager::create_stats_report() const
 {
-    const std::string query{"SELECT * FROM boss_dmg_ranking"};
+    std::vector<std::string> line_vec{};
+    char line[256]{};
 
-    const std::unique_ptr msg(DBManager::instance().DirectQuery(query.c_str()));
+    size_t participant_count{};
 
-    if (constexpr uint8_t sql_err_load_data{0U}; sql_err_load_data != msg->uiSQLErrno)
+    // the participants of the worker's bosses must not be read from this thread
+    if (nullptr != mp_worker) { participant_count = mp_worker->get_participant_count(); }
+    else
     {
-        sys_err("CBossDmgRankingManager::initialize - cannot load boss damage ranking data");
-
-        return;
+        for (const auto& boss_data: m_boss_info_vec)
+        {
+            if (nullptr != boss_data) { participant_count += boss_data->get_player_data()->get_player_count(); }
+        }
     }
 
-    if (constexpr uint8_t sql_zero_rows{0U}; sql_zero_rows == msg->Get()->uiNumRows)
-    {
-        sys_err("CBossDmgRankingManager::initialize - no boss damage ranking data found");
+    const auto registry_stats{get_registry_stats()};
 
-        return;
-    }
+    snprintf(line,
+        sizeof(line),
+        "bosses: %zu live, %zu participants, %llu erased, %llu reaped",
+        registry_stats.live_bosses,
+        participant_count,
+        static_cast<unsigned long long>(registry_stats.erased_bosses),
+        static_cast<unsigned long long>(registry_stats.reaped_bosses));
+    line_vec.emplace_back(line);
 
-    MYSQL_ROW row{};
-    while (nullptr != (row = mysql_fetch_row(msg->Get()->pSQLResult)))
-    {
-        uint32_t mob_vnum{};
-        str_to_number(mob_vnum, row[0]);
+    const auto add_call_line{[&line_vec, &line](const char* p_name, const perfutils::CallStats& call_stats)
+        {
+            const auto& latency{call_stats.latency};
+
+            snprintf(line,
+                sizeof(line),
+                "%s: %llu calls, %llu timed, mean %llu ns, p50 < %llu ns, p99 < %llu ns, max %llu ns",
+                p_name,
+                static_cast<unsigned long long>(call_stats.calls),
+                static_cast<unsigned long long>(latency.get_count()),
+                static_cast<unsigned long long>(latency.get_mean_ns()),
+                static_cast<unsigned long long>(latency.get_percentile_ns(50U)),
+                static_cast<unsigned long long>(latency.get_percentile_ns(99U)),
+                static_cast<unsigned long long>(latency.get_max_ns()));
+            line_vec.emplace_back(line);
+        }};
 
-        m_set_boss_vnum.emplace(mob_vnum);
+    add_call_line("damage_process", m_call_stats.damage_process);
+    add_call_line("set_bad_affect", m_call_stats.set_bad_affect);
+    add_call_line("send_rankings", m_call_stats.send_rankings);
+
+    snprintf(line,
+        sizeof(line),
+        "broadcasts: %llu, %.1f recipients each, %llu packets, %llu bytes",
+        static_cast<unsigned long long>(m_broadcast_stats.broadcasts),
+        0U == m_broadcast_stats.broadcasts ? 0.0
+                                           : static_cast<double>(m_broadcast_stats.recipients) /
+                                                 static_cast<double>(m_broadcast_stats.broadcasts),
+        static_cast<unsigned long long>(m_broadcast_stats.packets),
+        static_cast<unsigned long long>(m_broadcast_stats.bytes));
+    line_vec.emplace_back(line);
+
+    if (nullptr != mp_worker)
+    {
+        snprintf(line,
+            sizeof(line),
+            "worker: %llu events, %llu hits dropped on a full queue, %zu events waiting, "
+            "%zu erased bosses not given back yet",
+            static_cast<unsigned long long>(mp_worker->get_event_count()),
+            static_cast<unsigned long long>(mp_worker->get_dropped_event_count()),
+            mp_worker->get_pending_event_count(),
+            m_retiring_boss_deque.size());
+        line_vec.emplace_back(line);
     }
+
+    return line_vec;
 }
 
 /**
- * @brief Retrieve boss information based on boss ID and mob VID.
+ * @brief Set how often the stats report is written to the syslog
  *
- * @param boss_id_data The boss ID and mob VID to retrieve the information for.
- * @return std::optional<BossDamageRankingBossInfo*> Optional containing the
- * boss info if found, otherwise std::nullopt.
+ * @param interval The interval in seconds, 0 to turn the periodic report off, clamped to at most an hour
  */
-std::optional<CBossDamageRankingBossData*> CBossDamageRankingManager::get_boss_info(
-    const BossDamageRankingIdData& boss_id_data) const
+void CBossDamageRankingManager::set_stats_log_interval(const uint32_t interval) noexcept
 {
-    if (m_boss_info_vec.empty()) { return std::nullopt; }
-
-    const auto check_pred_func{[boss_id_data](const boss_damage_ranking_boss_data_t& boss_info)
-        {
-            const auto* const boss_info_ptr{boss_info->get_boss_info()};
+    m_stats_log_interval = std::min(interval, max_stats_log_interval_sec);
+}
 
-            if (nullptr == boss_info_ptr) { return false; }
+/**
+ * @brief Get how often the stats report is written to the syslog
+ *
+ * @return uint32_t The interval in seconds, 0 when the periodic report is off
+ */
+uint32_t CBossDamageRankingManager::get_stats_log_interval() const noexcept { return m_stats_log_interval; }
 
-            return boss_info_ptr->mob_vnum == boss_id_data.mob_vnum && boss_info_ptr->mob_vid == boss_id_data.mob_vid;
-        }};
+/**
+ * @brief Start recording the ranking activity into the flight recorder
+ *
+ * @param capacity The number of spans kept, the oldest are overwritten
+ */
+void CBossDamageRankingManager::start_trace(const size_t capacity) { m_flight_recorder.start(capacity); }
 
-#if __cplusplus >= 202002L
-    const auto& boss_info_iter{std::ranges::find_if(m_boss_info_vec, check_pred_func)};
-#else
-    const auto& boss_info_iter{std::find_if(m_boss_info_vec.begin(), m_boss_info_vec.end(), check_pred_func)};
-#endif
-    // Check if the boss information was not found
-    if (boss_info_iter == m_boss_info_vec.cend()) { return std::nullopt; }
+/**
+ * @brief Stop recording the ranking activity, the recorded spans are kept for a dump
+ */
+void CBossDamageRankingManager::stop_trace() noexcept { m_flight_recorder.stop(); }
 
-    return boss_info_iter->get();
-}
+/**
+ * @brief Check if the ranking activity is being recorded
+ *
+ * @return bool
+ */
+bool CBossDamageRankingManager::is_tracing() const noexcept { return m_flight_recorder.is_enabled(); }
 
 /**
- * @brief Validate character and boss information.
+ * @brief Write the recorded spans as a Chrome/Perfetto trace file
  *
- * @param p_character The character pointer.
- * @param boss_id_data The boss ID and mob VID to identify the boss.
- * @return Optional pair containing boss info and player data if validation succeeds, std::nullopt otherwise.
+ * @param file_name A plain file name, written to the working directory of the core
+ * @return std::optional<size_t> The number of spans written, or std::nullopt if the name was
+ * rejected, nothing was recorded or the file could not be written
  */
-std::optional<CBossDamageRankingManager::validate_data_t> CBossDamageRankingManager::validate_and_get_data(
-    LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data) const
+std::optional<size_t> CBossDamageRankingManager::dump_trace(const std::string& file_name) const
 {
-    if (nullptr == p_character || nullptr == p_character->GetDesc()) { return std::nullopt; }
-
-    const auto& boss_info = get_boss_info(boss_id_data);
-
-    if (std::nullopt == boss_info) { return std::nullopt; }
-
-    auto* player_data = boss_info.value()->get_player_data();
+    // the name comes from a GM, it must not leave the working directory
+    if (file_name.empty() || std::string::npos != file_name.find_first_of("/\\") ||
+        std::string::npos != file_name.find(".."))
+    {
+        return std::nullopt;
+    }
 
-    if (nullptr == player_data) { return std::nullopt; }
+    if (!m_flight_recorder.dump_chrome_trace(file_name.c_str())) { return std::nullopt; }
 
-    return std::make_pair(boss_info.value(), player_data);
+    return m_flight_recorder.get_event_count();
 }
 
 /**
- * @brief Add player to the damage list if not already present.
+ * @brief Check if boss is in the ranking
  *
- * @param player_data The player data object.
- * @param p_character The character pointer.
+ * @param mob_vnum
+ *
+ * @return bool
  */
-void CBossDamageRankingManager::ensure_player_in_ranking(
-    CBossDamageRankingPlayerData* player_data, LPCHARACTER p_character)
+bool CBossDamageRankingManager::is_boss_in_ranking(uint32_t mob_vnum) const noexcept
 {
-    if (const auto player_id{p_character->GetPlayerID()}; !player_data->is_player_in_ranking(player_id))
-    {
-        player_data->add_player(p_character);
-    }
+    return m_config->boss_vnum_filter.contains(mob_vnum);
 }
 
 /**
- * @brief Add player to damage list.
+ * @brief Send the boss damage ranking to all players that are currently logged in and in the ranking.
  *
- * @param p_character
- * @param boss_id_data
+ * @param boss_id_data The boss ID and mob VID to send the ranking for.
  */
-void CBossDamageRankingManager::add_player_to_list(
-    LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data) const
+void CBossDamageRankingManager::send_rankings_to_players(const BossDamageRankingIdData& boss_id_data)
 {
-    if (nullptr == p_character || nullptr == p_character->GetDesc()) { return; }
+    // the worker owns the rankings and broadcasts them itself
+    if (nullptr != mp_worker) { return; }
 
     const auto& boss_info{get_boss_info(boss_id_data)};
 
     if (std::nullopt == boss_info) { return; }
 
-    auto* player_data{boss_info.value()->get_player_data()};
-
-    if (nullptr == player_data) { return; }
-
-    ensure_player_in_ranking(player_data, p_character);
+    send_rankings_to_players(boss_info.value());
 }
 
 /**
- * @brief Process damage dealt to a boss.
+ * @brief Send the boss damage ranking to all players that are currently logged in and in the ranking.
  *
- * @param p_character The character ptr.
- * @param boss_id_data The boss ID and mob VID to identify the boss.
- * @param damage The amount of damage dealt to the boss.
+ * @param boss_data The boss data object.
  */
-void CBossDamageRankingManager::damage_process(
-    LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data, uint64_t damage) const
+void CBossDamageRankingManager::send_rankings_to_players(CBossDamageRankingBossData* boss_data)
 {
-    const auto validation_result = validate_and_get_data(p_character, boss_id_data);
+    // broadcasts are rare enough to time every one of them
+    const perfutils::SampledCallTimer call_timer{m_call_stats.send_rankings, 1U};
 
-    if (!validation_result.has_value()) { return; }
+    const auto boss_vid{boss_data->get_boss_info()->mob_vid};
+    const auto participant_count{static_cast<uint32_t>(boss_data->get_player_data()->get_player_count())};
 
-    auto* boss_info{validation_result->first};
-    auto* player_data{validation_result->second};
+    const perfutils::TraceSpan trace_span{
+        m_flight_recorder, "send_rankings_to_players", boss_vid, participant_count};
+
+    const auto& [ranking_packets, recipient_vec]{create_ranking_container(boss_data)};
 
-    ensure_player_in_ranking(player_data, p_character);
+    ++m_broadcast_stats.broadcasts;
+    m_broadcast_stats.recipients += recipient_vec.size();
 
-    const auto player_id{p_character->GetPlayerID()};
-    player_data->add_damage(player_id, damage);
+    for (const auto& recipient: recipient_vec)
+    {
+        // players that missed a version (just joined, or offline during a broadcast) get the full ranking
+        const bool has_base_version{
+            0U != ranking_packets.base_version && recipient.ranking_version == ranking_packets.base_version};
 
-    player_data->set_player_info_damage_percent(boss_info->get_boss_info()->max_hp);
+        const perfutils::TraceSpan send_span{m_flight_recorder, "send_ranking_to_player", boss_vid, participant_count};
 
-    send_rankings_to_players(boss_id_data);
+        send_ranking_to_player(recipient.p_character,
+            has_base_version ? ranking_packets.delta_packet : ranking_packets.full_packet,
+            recipient.damage_info);
+    }
 }
 
 /**
- * @brief Set a bad affect flag for a character in the damage ranking of a boss.
+ * @brief Given the participant data of a boss, creates the vector of online
+ * characters to send the rankings to, each with its personal damage row.
  *
- * @param boss_id_data The boss ID and mob VID to identify the boss.
- * @param player_id The character ID to set the flag for.
- * @param type The bad affect flag to be set.
+ * @param player_data The participant data
+ * @param boss_info The boss information
+ *
+ * @return std::vector<ranking_recipient_t> The recipients and their damage rows
  */
-void CBossDamageRankingManager::set_bad_affect(
-    const BossDamageRankingIdData& boss_id_data, uint32_t player_id, BadAffectType type) const
+std::vector<CBossDamageRankingManager::ranking_recipient_t> CBossDamageRankingManager::create_recipient_vector(
+    const CBossDamageRankingPlayerData& player_data, const BossDamageRankingBossInfo& boss_info)
 {
-    const auto& boss_info{get_boss_info(boss_id_data)};
+    const auto& character_vec{player_data.get_characters()};
+    const auto rank_vec{player_data.get_player_ranks()};
+    const auto now{get_dword_time()};
 
-    if (std::nullopt == boss_info) { return; }
+    std::vector<ranking_recipient_t> recipient_vec{};
+    recipient_vec.reserve(character_vec.size());
 
-    const auto* const player_data{boss_info.value()->get_player_data()};
+    for (size_t player_slot{}; player_slot < character_vec.size(); ++player_slot)
+    {
+        auto* const p_character{character_vec[player_slot]};
+
+        // destroyed characters were detached; a character still logging out has no descriptor
+        if (nullptr == p_character || nullptr == p_character->GetDesc()) { continue; }
 
-    player_data->set_bad_affect_flag(player_id, type);
+        const auto slot{static_cast<player_slot_t>(player_slot)};
+
+        recipient_vec.push_back({p_character,
+            slot,
+            player_data.get_ranking_version(slot),
+            create_damage_info(player_data.get_damage(slot),
+                boss_info,
+                rank_vec[player_slot],
+                character_vec.size(),
+                player_data.get_dps(slot, now))});
+    }
 
-    send_rankings_to_players(boss_id_data);
+    return recipient_vec;
 }
 
 /**
- * @brief Add a boss to the list of bosses tracked by the damage ranking
- * manager.
+ * @brief Create the personal damage row of a participant
  *
- * @param boss_data The boss information to add to the list.
+ * @param damage The damage dealt by the participant
+ * @param boss_info The boss information
+ * @param rank The 1-based rank of the participant
+ * @param participant_count The number of participants of the boss
+ * @param dps The live DPS of the participant
+ *
+ * @return SPacketGCBossDamageRankingDamageInfo The damage row
  */
-void CBossDamageRankingManager::add_boss_to_list(const BossDamageRankingBossInfo& boss_data)
+SPacketGCBossDamageRankingDamageInfo CBossDamageRankingManager::create_damage_info(const uint64_t damage,
+    const BossDamageRankingBossInfo& boss_info,
+    const uint32_t rank,
+    const size_t participant_count,
+    const uint64_t dps)
 {
-    if (!is_boss_in_ranking(boss_data.mob_vnum)) { return; }
+    static constexpr auto max_count{std::numeric_limits<uint16_t>::max()};
 
-    auto p_boss_info{std::make_unique<BossDamageRankingBossInfo>(boss_data)};
+    SPacketGCBossDamageRankingDamageInfo damage_info{};
+    damage_info.rank = static_cast<uint16_t>(std::min<uint32_t>(rank, max_count));
+    damage_info.participant_count = static_cast<uint16_t>(std::min<size_t>(participant_count, max_count));
+    damage_info.percent_damage = calc_damage_percent(damage, boss_info);
+    damage_info.damage = damage;
+    damage_info.dps = static_cast<uint32_t>(std::min<uint64_t>(dps, std::numeric_limits<uint32_t>::max()));
 
-    m_boss_info_vec.emplace_back(std::make_unique<CBossDamageRankingBossData>(std::move(p_boss_info)));
+    return damage_info;
 }
 
 /**
- * @brief Erase a boss from the list of bosses tracked by the damage ranking
- * manager.
+ * @brief Create a vector of packet information for the boss damage ranking
  *
- * @param boss_id_data The boss ID and mob VID to identify the boss to be
- * erased.
+ * @param player_data The participant data holding the top ranking
+ * @param boss_info The boss information, used to compute the damage percents
+ *
+ * @return std::vector<SPacketGCBossDamageRankingInfo> The vector of packet
+ * information
+ *
+ * @details The only place the names and races of the side table are read.
  */
-void CBossDamageRankingManager::erase_boss_from_list(const BossDamageRankingIdData& boss_id_data)
+std::vector<SPacketGCBossDamageRankingInfo> CBossDamageRankingManager::create_ranking_info_vector(
+    const CBossDamageRankingPlayerData& player_data, const BossDamageRankingBossInfo& boss_info)
 {
-    if (std::nullopt == get_boss_info(boss_id_data)) { return; }
+    const auto& top_vec{player_data.get_top_players()};
 
-    const auto erase_pred_func{[boss_id_data](const boss_damage_ranking_boss_data_t& boss_info)
+    std::vector<SPacketGCBossDamageRankingInfo> info_vec(top_vec.size());
+
+    const auto pred_func{[&player_data, &boss_info](const player_slot_t player_slot)
         {
-            const auto* const boss_info_ptr{boss_info->get_boss_info()};
+            const auto& profile{player_data.get_player_profile(player_slot)};
 
-            if (!boss_info_ptr) { return false; }
+            SPacketGCBossDamageRankingInfo info{};
+            static_assert(sizeof(info.name) == sizeof(profile.player_name));
+            std::memcpy(info.name, profile.player_name.data(), sizeof(info.name));
+            info.race = profile.race;
+            info.percent_damage = calc_damage_percent(player_data.get_damage(player_slot), boss_info);
+            info.bad_affect_flag = player_data.get_bad_affect_flag(player_slot);
 
-            return boss_info_ptr == boss_id_data;
+            return info;
         }};
-
 #if __cplusplus >= 202002L
-    std::erase_if(m_boss_info_vec, erase_pred_func);
+    std::ranges::transform(top_vec, info_vec.begin(), pred_func);
 #else
-    m_boss_info_vec.erase(
-        std::remove_if(m_boss_info_vec.begin(), m_boss_info_vec.end(), erase_pred_func), m_boss_info_vec.end());
+    std::transform(top_vec.begin(), top_vec.end(), info_vec.begin(), pred_func);
 #endif
+    return info_vec;
 }
 
 /**
- * @brief Check if boss is in the ranking
+ * @brief Create the party and guild top rankings of a boss
  *
- * @param mob_vnum
+ * @param player_data The participant data holding the groups
+ * @param boss_info The boss information, used to compute the damage percents
  *
- * @return bool
+ * @return boss_damage_ranking_group_ranking_vec_t The rankings of the group types with at least one group
  */
-bool CBossDamageRankingManager::is_boss_in_ranking(uint32_t mob_vnum) const noexcept
+boss_damage_ranking_group_ranking_vec_t CBossDamageRankingManager::create_group_ranking_vector(
+    const CBossDamageRankingPlayerData& player_data, const BossDamageRankingBossInfo& boss_info)
+{
+    boss_damage_ranking_group_ranking_vec_t group_ranking_vec{};
+
+    for (size_t group_type{}; group_type < group_type_count; ++group_type)
+    {
+        const auto& group_data{player_data.get_group_data(group_type)};
+        const auto& top_vec{group_data.get_top_groups()};
+
+        if (top_vec.empty()) { continue; }
+
+        auto& group_ranking{group_ranking_vec.emplace_back()};
+        group_ranking.group_type = static_cast<EBossDamageRankingGroupType>(group_type);
+        group_ranking.info_vec.resize(top_vec.size());
+
+        for (size_t position{}; position < top_vec.size(); ++position)
+        {
+            const auto group_slot{top_vec[position]};
+            const auto& profile{group_data.get_group_profile(group_slot)};
+            auto& info{group_ranking.info_vec[position]};
+
+            static_assert(sizeof(info.name) == sizeof(profile.group_name));
+            std::memcpy(info.name, profile.group_name.data(), sizeof(info.name));
+            info.member_count = group_data.get_member_count(group_slot);
+            info.percent_damage = calc_damage_percent(group_data.get_damage(group_slot), boss_info);
+        }
+    }
+
+    return group_ranking_vec;
+}
+
+/**
+ * @brief Append one BOSS_DMG_RANKING_GROUP_INFO packet per group ranking
+ *
+ * @param packet_builder The builder holding the ranking packet
+ * @param boss_vid The VID of the boss
+ * @param group_ranking_vec The group rankings
+ */
+void CBossDamageRankingManager::add_group_rankings(networkutils::shared_packet_builder_t& packet_builder,
+    const uint32_t boss_vid,
+    const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec)
+{
+    for (const auto& [group_type, info_vec]: group_ranking_vec)
+    {
+        SPacketGCBossDamageRankingGroupGeneralInfo group_info{};
+        group_info.boss_vid = boss_vid;
+        group_info.group_type = static_cast<uint8_t>(group_type);
+        group_info.rank_size = static_cast<uint8_t>(info_vec.size());
+
+        packet_builder
+            .add_header(HEADER_GC_BOSS_DMG_RANKING, EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_GROUP_INFO)
+            .add_payload(group_info)
+            .add_payload(info_vec);
+    }
+}
+
+/**
+ * @brief Serialize the full top ranking once for every recipient of a broadcast
+ *
+ * @param boss_vid The VID of the boss
+ * @param version The ranking version
+ * @param info_vec The vector of top ranking information
+ * @param group_ranking_vec The group rankings appended after the top ranking
+ *
+ * @return networkutils::shared_packet_t The serialized ranking packet
+ *
+ * @details The top ranking is bounded by the top limit (at most 254 rows),
+ * so rank_size never wraps whatever the number of participants.
+ */
+networkutils::shared_packet_t CBossDamageRankingManager::create_ranking_packet(const uint32_t boss_vid,
+    const uint32_t version,
+    const std::vector<SPacketGCBossDamageRankingInfo>& info_vec,
+    const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec)
 {
 #if __cplusplus >= 202002L
-    return m_set_boss_vnum.contains(mob_vnum);
+    const SPacketGCRankingGeneralInfo init_packet{
+        .boss_vid = boss_vid,
+        .version = version,
+        .rank_size = static_cast<uint8_t>(info_vec.size()),
+    };
 #else
-    return m_set_boss_vnum.count(mob_vnum);
+    SPacketGCRankingGeneralInfo init_packet{};
+    init_packet.boss_vid = boss_vid;
+    init_packet.version = version;
+    init_packet.rank_size = static_cast<uint8_t>(info_vec.size());
 #endif
+
+    static thread_local networkutils::shared_packet_builder_t packet_builder{};
+    packet_builder
+        .add_header(HEADER_GC_BOSS_DMG_RANKING, EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RANK_INFO)
+        .add_payload(init_packet)
+        .add_payload(info_vec);
+
+    add_group_rankings(packet_builder, boss_vid, group_ranking_vec);
+
+    return packet_builder.build();
 }
 
 /**
- * @brief Send the boss damage ranking to all players that are currently logged in and in the ranking.
+ * @brief Serialize the changed top ranking rows once for every recipient of a broadcast
  *
- * @param boss_id_data The boss ID and mob VID to send the ranking for.
+ * @param boss_vid The VID of the boss
+ * @param base_version The ranking version the delta applies to
+ * @param version The ranking version after the delta
+ * @param info_vec The vector of top ranking information
+ * @param row_mask_vec The changed fields of each row
+ * @param group_ranking_vec The changed group rankings appended after the delta
+ *
+ * @return networkutils::shared_packet_t The serialized delta packet
  */
-void CBossDamageRankingManager::send_rankings_to_players(const BossDamageRankingIdData& boss_id_data) const
+networkutils::shared_packet_t CBossDamageRankingManager::create_ranking_delta_packet(const uint32_t boss_vid,
+    const uint32_t base_version,
+    const uint32_t version,
+    const std::vector<SPacketGCBossDamageRankingInfo>& info_vec,
+    const std::vector<uint8_t>& row_mask_vec,
+    const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec)
 {
-    const auto ranking_list{create_ranking_container(boss_id_data)};
-
-    if (std::nullopt == ranking_list) { return; }
+    SPacketGCRankingDeltaInfo delta_info{};
+    delta_info.boss_vid = boss_vid;
+    delta_info.base_version = base_version;
+    delta_info.version = version;
+    delta_info.rank_size = static_cast<uint8_t>(info_vec.size());
+#if __cplusplus >= 202002L
+    delta_info.row_count = static_cast<uint8_t>(
+        std::ranges::count_if(row_mask_vec, [](const uint8_t mask) { return 0U != mask; }));
+#else
+    delta_info.row_count = static_cast<uint8_t>(
+        std::count_if(row_mask_vec.begin(), row_mask_vec.end(), [](const uint8_t mask) { return 0U != mask; }));
+#endif
 
-    const auto& [info_vec, player_vec]{ranking_list.value()};
+    static thread_local networkutils::shared_packet_builder_t packet_builder{};
+    packet_builder
+        .add_header(HEADER_GC_BOSS_DMG_RANKING, EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RANK_DELTA)
+        .add_payload(delta_info);
 
-    for (auto* const p_character: player_vec)
+    for (size_t position{}; position < info_vec.size(); ++position)
     {
-        if (nullptr == p_character) { continue; }
+        const auto field_mask{row_mask_vec[position]};
+
+        if (0U == field_mask) { continue; }
+
+        const auto& info{info_vec[position]};
+
+        packet_builder.add_payload(SPacketGCBossDamageRankingDeltaRow{static_cast<uint8_t>(position), field_mask});
+
+        if (0U != (field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::PLAYER)))
+        {
+            packet_builder.add_payload(info.race).add_payload(info.name);
+        }
+
+        if (0U != (field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::PERCENT_DAMAGE)))
+        {
+            packet_builder.add_payload(info.percent_damage);
+        }
 
-        send_ranking_to_player(p_character, info_vec);
+        if (0U != (field_mask & static_cast<uint8_t>(EBossDamageRankingRowField::BAD_AFFECT_FLAG)))
+        {
+            packet_builder.add_payload(info.bad_affect_flag);
+        }
     }
+
+    add_group_rankings(packet_builder, boss_vid, group_ranking_vec);
+
+    return packet_builder.build();
 }
 
 /**
- * @brief Given a sorted vector of player information, creates a vector of
- * LPCHARACTER objects which can be used to send the rankings to the players.
+ * @brief Compare the top ranking with the last broadcast rows and remember it as broadcast
  *
- * @param sorted_vec The sorted vector of player information
+ * @param sent_rows The last broadcast rows, updated to the current ranking
+ * @param player_data The participant data holding the current top ranking
+ * @param info_vec The packet information of the current top ranking
  *
- * @return std::vector<LPCHARACTER> The vector of LPCHARACTER objects
+ * @return std::vector<uint8_t> The changed EBossDamageRankingRowField bits of each row
  */
-std::vector<LPCHARACTER> CBossDamageRankingManager::get_character_vector_from_sorted_vec(
-    const boss_damage_ranking_player_info_vec_t& sorted_vec)
+std::vector<uint8_t> CBossDamageRankingManager::update_sent_rows(std::pmr::vector<BossDamageRankingRowState>& sent_rows,
+    const CBossDamageRankingPlayerData& player_data,
+    const std::vector<SPacketGCBossDamageRankingInfo>& info_vec)
 {
-    std::vector<LPCHARACTER> player_vec(sorted_vec.size());
+    const auto& top_vec{player_data.get_top_players()};
 
-#if __cplusplus >= 202002L
-    std::ranges::transform(sorted_vec,
-        player_vec.begin(),
-        [](const auto& player_info)
+    std::vector<uint8_t> row_mask_vec(top_vec.size());
+
+    // rows that were not broadcast yet hold player_id 0 and are sent whole
+    sent_rows.resize(top_vec.size());
+
+    for (size_t position{}; position < top_vec.size(); ++position)
+    {
+        const auto player_slot{top_vec[position]};
+        const auto player_id{player_data.get_player_ids()[player_slot]};
+        const auto& info{info_vec[position]};
+        auto& sent_row{sent_rows[position]};
+        auto& field_mask{row_mask_vec[position]};
+
+        if (sent_row.player_id != player_id)
         {
-            return CHARACTER_MANAGER::instance().FindByPID(player_info->player_id);
-        });
-#else
-    std::transform(sorted_vec.begin(),
-        sorted_vec.end(),
-        player_vec.begin(),
-        [](const auto& player_info)
+            field_mask |= static_cast<uint8_t>(EBossDamageRankingRowField::PLAYER);
+            sent_row.player_id = player_id;
+        }
+
+        if (sent_row.percent_damage != info.percent_damage)
         {
-            return CHARACTER_MANAGER::instance().FindByPID(player_info->player_id);
-        });
-#endif
-    return player_vec;
+            field_mask |= static_cast<uint8_t>(EBossDamageRankingRowField::PERCENT_DAMAGE);
+            sent_row.percent_damage = info.percent_damage;
+        }
+
+        if (sent_row.bad_affect_flag != info.bad_affect_flag)
+        {
+            field_mask |= static_cast<uint8_t>(EBossDamageRankingRowField::BAD_AFFECT_FLAG);
+            sent_row.bad_affect_flag = info.bad_affect_flag;
+        }
+    }
+
+    return row_mask_vec;
 }
 
 /**
- * @brief Create a vector of packet information for the boss damage ranking
+ * @brief Compare the group rankings with the last broadcast rows and remember them as broadcast
  *
- * @param sorted_vec The sorted vector of player information
+ * @param boss_data The boss data holding the last broadcast group rows
+ * @param group_ranking_vec The current group rankings
  *
- * @return std::vector<SPacketGCBossDamageRankingInfo> The vector of packet
- * information
+ * @return boss_damage_ranking_group_ranking_vec_t The group rankings with at least one changed row
+ *
+ * @details A group ranking is short, so a changed one is sent whole instead of row by row.
  */
-std::vector<SPacketGCBossDamageRankingInfo> CBossDamageRankingManager::create_ranking_info_vector(
-    const boss_damage_ranking_player_info_vec_t& sorted_vec)
+boss_damage_ranking_group_ranking_vec_t CBossDamageRankingManager::update_sent_group_rows(
+    CBossDamageRankingBossData& boss_data, const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec)
 {
-    std::vector<SPacketGCBossDamageRankingInfo> info_vec(sorted_vec.size());
+    boss_damage_ranking_group_ranking_vec_t changed_ranking_vec{};
+    const auto* const player_data{boss_data.get_player_data()};
+
+    for (const auto& group_ranking: group_ranking_vec)
+    {
+        const auto group_type{static_cast<size_t>(group_ranking.group_type)};
+        const auto& group_data{player_data->get_group_data(group_type)};
+        const auto& top_vec{group_data.get_top_groups()};
+        auto& sent_rows{boss_data.get_sent_group_rows(group_type)};
+
+        bool is_changed{sent_rows.size() != top_vec.size()};
+        sent_rows.resize(top_vec.size());
 
-    const auto pred_func{[](const boss_damage_ranking_player_info_t& player_info)
+        for (size_t position{}; position < top_vec.size(); ++position)
         {
-            SPacketGCBossDamageRankingInfo info{};
-            strncpy(info.name, player_info->player_name.data(), player_info->player_name.size() - 1);
-            info.race = player_info->race;
-            info.percent_damage = player_info->percent_damage;
-            info.bad_affect_flag = player_info->bad_affect_flag;
+            const auto& info{group_ranking.info_vec[position]};
+            const auto group_slot{top_vec[position]};
+            const BossDamageRankingGroupRowState row{group_data.get_group_profile(group_slot).group_id,
+                group_data.get_name_version(group_slot),
+                info.member_count,
+                info.percent_damage};
+            auto& sent_row{sent_rows[position]};
+
+            if (sent_row.group_id == row.group_id && sent_row.name_version == row.name_version &&
+                sent_row.member_count == row.member_count && sent_row.percent_damage == row.percent_damage)
+            {
+                continue;
+            }
+
+            sent_row = row;
+            is_changed = true;
+        }
+
+        if (is_changed) { changed_ranking_vec.emplace_back(group_ranking); }
+    }
 
-            return info;
-        }};
-#if __cplusplus >= 202002L
-    std::ranges::transform(sorted_vec, info_vec.begin(), pred_func);
-#else
-    std::transform(sorted_vec.begin(), sorted_vec.end(), info_vec.begin(), pred_func);
-#endif
-    return info_vec;
+    return changed_ranking_vec;
 }
 
 /**
  * @brief Send boss damage rankings to a character
  *
  * @param p_character The character to which the rankings should be sent
- * @param info_vec The vector of ranking information to be sent
+ * @param ranking_packet The serialized top ranking or delta, shared by every recipient
+ * @param damage_info The personal damage row of the character
  */
-void CBossDamageRankingManager::send_ranking_to_player(
-    LPCHARACTER p_character, const std::vector<SPacketGCBossDamageRankingInfo>& info_vec)
+void CBossDamageRankingManager::send_ranking_to_player(LPCHARACTER p_character,
+    const networkutils::shared_packet_t& ranking_packet,
+    const SPacketGCBossDamageRankingDamageInfo& damage_info)
 {
-#if __cplusplus >= 202002L
-    const SPacketGCRankingGeneralInfo init_packet{
-        .rank_size = static_cast<uint8_t>(info_vec.size()),
-    };
-#else
-    SPacketGCRankingGeneralInfo init_packet{};
-    init_packet.rank_size = static_cast<uint8_t>(info_vec.size());
-#endif
+    networkutils::DynamicPacket<SPacketGCBossDamageRankingDamageInfo> damage_packet{};
+    damage_packet.header_packet.header = HEADER_GC_BOSS_DMG_RANKING;
+    damage_packet.header_packet.sub_header =
+        static_cast<uint8_t>(EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_DAMAGE_INFO);
+    damage_packet.payload = damage_info;
 
-    static networkutils::DynamicPacketBuilder packet_builder{};
-    packet_builder
-        .add_header(HEADER_GC_BOSS_DMG_RANKING, EPacketCGBossDamageRankingSubHeaderType::BOSS_DMG_RANKING_RANK_INFO)
-        .add_payload(init_packet)
-        .add_payload(info_vec)
-        .send_to_client(p_character);
+    networkutils::send_to_client(p_character, ranking_packet, damage_packet);
+
+    m_broadcast_stats.packets += 2U;
+    m_broadcast_stats.bytes += ranking_packet->size() + sizeof(damage_packet);
 }
 
 /**
  * @brief Create a container with the ranking information and characters for a boss
  *
- * @param boss_id_data The id data of the boss for which the container should be created
+ * @param boss_data The boss data for which the container should be created
  *
- * @return std::tuple<std::vector<SPacketGCBossDamageRankingInfo>, std::vector<LPCHARACTER>>
- * A tuple containing the ranking information and characters for the boss
+ * @return std::tuple<RankingPackets, std::vector<ranking_recipient_t>>
+ * A tuple containing the serialized top ranking and the recipients for the boss
  *
- * @throws std::runtime_error If the boss info is not found
+ * @details Starts a new ranking version; every returned recipient is recorded as holding it.
  */
-std::optional<CBossDamageRankingManager::ranking_container_t> CBossDamageRankingManager::create_ranking_container(
-    const BossDamageRankingIdData& boss_id_data) const
+CBossDamageRankingManager::ranking_container_t CBossDamageRankingManager::create_ranking_container(
+    CBossDamageRankingBossData* boss_data)
 {
-    const auto& p_boss_info{get_boss_info(boss_id_data)};
+    auto* const player_data{boss_data->get_player_data()};
+    const auto& boss_info{*boss_data->get_boss_info()};
+    const auto participant_count{static_cast<uint32_t>(player_data->get_player_count())};
+
+    const perfutils::TraceSpan trace_span{
+        m_flight_recorder, "create_ranking_container", boss_info.mob_vid, participant_count};
+
+    std::vector<SPacketGCBossDamageRankingInfo> info_vec{};
+    boss_damage_ranking_group_ranking_vec_t group_ranking_vec{};
+
+    {
+        const perfutils::TraceSpan info_span{
+            m_flight_recorder, "create_ranking_info_vector", boss_info.mob_vid, participant_count};
+
+        // percents are only computed for the rows that are actually sent
+        info_vec = create_ranking_info_vector(*player_data, boss_info);
+        group_ranking_vec = create_group_ranking_vector(*player_data, boss_info);
+    }
 
-    if (std::nullopt == p_boss_info) { return std::nullopt; }
+    RankingPackets ranking_packets{};
+    ranking_packets.base_version = boss_data->get_ranking_version();
+    const auto version{boss_data->next_ranking_version()};
 
-    const auto& sorted_vec{p_boss_info.value()->get_player_data()->get_sorted_player_info_vec()};
+    {
+        const perfutils::TraceSpan packet_span{m_flight_recorder, "build_packets", boss_info.mob_vid, participant_count};
+
+        const auto row_mask_vec{update_sent_rows(boss_data->get_sent_rows(), *player_data, info_vec)};
+        const auto changed_group_ranking_vec{update_sent_group_rows(*boss_data, group_ranking_vec)};
+
+        ranking_packets.full_packet = create_ranking_packet(boss_info.mob_vid, version, info_vec, group_ranking_vec);
+        ranking_packets.delta_packet = create_ranking_delta_packet(boss_info.mob_vid,
+            ranking_packets.base_version,
+            version,
+            info_vec,
+            row_mask_vec,
+            changed_group_ranking_vec);
+    }
 
-    const auto info_vec{create_ranking_info_vector(sorted_vec)};
+    auto recipient_vec{create_recipient_vector(*player_data, boss_info)};
 
-    const auto player_vec{get_character_vector_from_sorted_vec(sorted_vec)};
+    for (const auto& recipient: recipient_vec)
+    {
+        player_data->set_ranking_version(recipient.player_slot, version);
+    }
 
-    return std::make_tuple(info_vec, player_vec);
+    return std::make_tuple(std::move(ranking_packets), std::move(recipient_vec));
 }
 
 /**
- * @brief Reload the boss damage ranking manager from the database
+ * @brief Reload the boss damage ranking manager from the database, on this core and its peers
  */
 void CBossDamageRankingManager::reload() noexcept
 {
-    initialize();
+    request_config_load(true);
+}
+
+/**
+ * @brief Set the minimum time between two ranking broadcasts of bosses whose row leaves broadcast_interval_ms NULL
+ *
+ * @param interval The broadcast interval in milliseconds
+ */
+void CBossDamageRankingManager::set_broadcast_interval(const uint32_t interval) noexcept
+{
+    m_broadcast_interval = interval;
+}
+
+/**
+ * @brief Set the top ranking size of newly spawned bosses whose row leaves top_n NULL
+ *
+ * @param top_limit The top ranking size
+ */
+void CBossDamageRankingManager::set_top_limit(const uint8_t top_limit) noexcept
+{
+    m_top_limit = top_limit;
+}
+
+/**
+ * @brief Choose whether the rankings are computed on a worker thread, read once by initialize()
+ *
+ * @param enabled True to start the worker thread
+ *
+ * @details With the worker the game thread only validates the hits and queues them;
+ * the arenas of its fights are not counted in the allocation stats.
+ */
+void CBossDamageRankingManager::set_worker_thread(const bool enabled) noexcept { m_use_worker_thread = enabled; }
+
+/**
+ * @brief Set the directory the event logs of killed bosses are written to
+ *
+ * @param directory The directory, empty to record no event log
+ *
+ * @details Read when a boss spawns, so bosses already tracked keep their setting.
+ */
+void CBossDamageRankingManager::set_event_log_dir(std::string directory) { m_event_log_dir = std::move(directory); }
+
+/**
+ * @brief Set the number of hits and bad affects kept in the event log of each boss
+ *
+ * @param capacity The number of events, rounded up to a power of two
+ */
+void CBossDamageRankingManager::set_event_log_capacity(const uint32_t capacity) noexcept
+{
+    m_event_log_capacity = capacity;
+}
 
-    static constexpr uint8_t p2p_header{HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING};
-    P2P_MANAGER::Instance().Send(&p2p_header, sizeof(uint8_t));
+/**
+ * @brief Get the allocation counters of the boss records and the per-fight arenas
+ *
+ * @return BossDamageRankingAllocationStats The allocation counters
+ */
+BossDamageRankingAllocationStats CBossDamageRankingManager::get_allocation_stats() const noexcept
+{
+    return {m_boss_pool.get_stats(), m_arena_upstream.get_stats()};
 }
 
 } // namespace bossdamageranking
@@ -1,41 +1,233 @@
 #ifndef BOSSDAMAGERANKINGMANAGER_HPP
 #define BOSSDAMAGERANKINGMANAGER_HPP
 
+#include "batchedinsert.hpp"
 #include "bossdamageranking.hpp"
+#include "bossdamagerankingconfig.hpp"
+#include "bossdamagerankingworker.hpp"
+#include "flightrecorder.hpp"
+#include "latencystats.hpp"
+#include "networkutils.hpp"
 #include "packet.h"
 
+#include <deque>
+
+class SQLMsg;
+
 namespace bossdamageranking {
+/**
+ * @brief Allocation counters of the boss damage ranking
+ */
+struct BossDamageRankingAllocationStats
+{
+    /**
+     * @brief Boss records taken from the slab pool
+     */
+    memutils::AllocationStats boss_records{};
+
+    /**
+     * @brief Blocks requested by the per-fight arenas
+     */
+    memutils::AllocationStats arena_blocks{};
+};
+
+/**
+ * @brief Counters of the boss registry
+ */
+struct BossDamageRankingRegistryStats
+{
+    /**
+     * @brief Bosses tracked right now
+     */
+    size_t live_bosses{};
+
+    /**
+     * @brief Bosses erased on death, destruction or map teardown
+     */
+    uint64_t erased_bosses{};
+
+    /**
+     * @brief Leaked bosses found and erased by the reaper
+     */
+    uint64_t reaped_bosses{};
+};
+
+/**
+ * @brief Counters of the ranking broadcasts
+ */
+struct BossDamageRankingBroadcastStats
+{
+    /**
+     * @brief Ranking broadcasts of a boss to its online participants
+     */
+    uint64_t broadcasts{};
+
+    /**
+     * @brief Participants the broadcasts were sent to
+     */
+    uint64_t recipients{};
+
+    /**
+     * @brief Ranking packets sent to clients, broadcasts and joins alike
+     */
+    uint64_t packets{};
+
+    /**
+     * @brief Bytes of the ranking packets
+     */
+    uint64_t bytes{};
+};
+
+/**
+ * @brief Call counters and sampled latencies of the hot paths
+ */
+struct BossDamageRankingCallStats
+{
+    perfutils::CallStats damage_process{};
+    perfutils::CallStats set_bad_affect{};
+    perfutils::CallStats send_rankings{};
+};
+
+/**
+ * @brief Top ranking of the parties or the guilds of a boss
+ */
+struct BossDamageRankingGroupRanking
+{
+    EBossDamageRankingGroupType group_type{};
+    std::vector<SPacketGCBossDamageRankingGroupInfo> info_vec{};
+};
+
+/**
+ * @brief Group rankings serialized with a ranking, one per group type
+ */
+using boss_damage_ranking_group_ranking_vec_t = std::vector<BossDamageRankingGroupRanking>;
+
 class CBossDamageRankingManager final : public singleton<CBossDamageRankingManager> {
     /**
      * @brief
      */
-    using boss_damage_ranking_boss_data_t = std::unique_ptr<CBossDamageRankingBossData>;
+    using boss_damage_ranking_boss_data_t = memutils::ObjectPool<CBossDamageRankingBossData>::ptr_t;
 
     /**
      * @brief
      */
     using boss_damage_ranking_vec_t = std::vector<boss_damage_ranking_boss_data_t>;
 
+    /**
+     * @brief Index of a tracked boss inside m_boss_info_vec
+     */
+    using boss_slot_t = hashutils::FlatIndex<uint32_t>::slot_t;
+
+    /**
+     * @brief Recipient of a ranking broadcast and its personal damage row
+     */
+    struct RankingRecipient
+    {
+        LPCHARACTER p_character{};
+        player_slot_t player_slot{};
+        uint32_t ranking_version{};
+        SPacketGCBossDamageRankingDamageInfo damage_info{};
+    };
+
+    /**
+     * @brief Packets of one ranking broadcast
+     */
+    struct RankingPackets
+    {
+        networkutils::shared_packet_t full_packet{};
+        networkutils::shared_packet_t delta_packet{};
+        uint32_t base_version{};
+    };
+
+    /**
+     * @brief
+     */
+    using ranking_recipient_t = RankingRecipient;
+
     /**
      * @brief
      */
-    using ranking_container_t = std::tuple<std::vector<SPacketGCBossDamageRankingInfo>, std::vector<LPCHARACTER>>;
+    using ranking_container_t = std::tuple<RankingPackets, std::vector<ranking_recipient_t>>;
 
     using validate_data_t = std::pair<CBossDamageRankingBossData*, CBossDamageRankingPlayerData*>;
 
+    /**
+     * @brief Participant slot a character is cached in
+     */
+    struct ParticipantRef
+    {
+        BossDamageRankingHandle boss_handle{};
+        player_slot_t player_slot{};
+    };
+
+    /**
+     * @brief Erased boss waiting for the worker thread to give its record back
+     */
+    struct RetiringBoss
+    {
+        boss_damage_ranking_boss_data_t p_boss_data{};
+        EBossDamageRankingFightEnd fight_end{};
+    };
+
   public:
     /**
      * @brief Initialize the boss damage ranking manager
+     *
+     * @details Loads the config with a blocking query, so it is only meant for the
+     * boot, before any player is connected. A failed query keeps the current config.
      */
     void initialize() noexcept;
 
+    /**
+     * @brief Load the config from the database without blocking the game thread
+     *
+     * @param share_with_peers Whether the loaded snapshot is sent to the other cores.
+     *
+     * @details The query goes through the asynchronous DB queue; its snapshot is built
+     * when the result comes back and published on the next pulse. A result that
+     * arrives after a newer request was made is dropped.
+     */
+    void request_config_load(bool share_with_peers = false);
+
+    /**
+     * @brief Handle a HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING packet of a peer
+     *
+     * @param p_desc The peer descriptor.
+     * @param p_data The packet data.
+     * @param size The number of bytes available.
+     * @return int The number of bytes read past the fixed packet, or -1 if the packet is not complete yet.
+     *
+     * @details A config is applied straight from the packet on the next pulse. A config whose
+     * checksum does not match is dropped and a resync is requested from the sender, once.
+     * A checksum announcement of a newer snapshot also asks for a resync.
+     */
+    int recv_p2p_packet(LPDESC p_desc, const char* p_data, size_t size);
+
+    /**
+     * @brief Announce the checksum of the newest config snapshot to the other cores
+     *
+     * @param p_desc The peer to announce it to, or nullptr for every peer.
+     *
+     * @details A peer whose snapshot differs and is older asks for a resync; one whose
+     * snapshot is newer answers with its own checksum, so this core asks instead.
+     */
+    void send_config_checksum(LPDESC p_desc) const;
+
     /**
      * @brief Add player to damage list.
      *
      * @param p_character
      * @param boss_id_data
      */
-    void add_player_to_list(LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data) const;
+    void add_player_to_list(LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data);
+
+    /**
+     * @brief Add player to damage list.
+     *
+     * @param p_character
+     * @param boss_handle The handle of the boss.
+     */
+    void add_player_to_list(LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle);
 
     /**
      * @brief Process damage dealt to a boss.
@@ -44,7 +236,16 @@ class CBossDamageRankingManager final : public singleton<CBossDamageRankingManag
      * @param boss_id_data The boss ID and mob VID to identify the boss.
      * @param damage The amount of damage dealt to the boss.
      */
-    void damage_process(LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data, uint64_t damage) const;
+    void damage_process(LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data, uint64_t damage);
+
+    /**
+     * @brief Process damage dealt to a boss.
+     *
+     * @param p_character The character ptr.
+     * @param boss_handle The handle of the boss.
+     * @param damage The amount of damage dealt to the boss.
+     */
+    void damage_process(LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle, uint64_t damage);
 
     /**
      * @brief Set a bad affect flag for a character in the damage ranking of a boss.
@@ -53,21 +254,155 @@ class CBossDamageRankingManager final : public singleton<CBossDamageRankingManag
      * @param player_id The character ID to set the flag for.
      * @param type The bad affect flag to be set.
      */
-    void set_bad_affect(const BossDamageRankingIdData& boss_id_data, uint32_t player_id, BadAffectType type) const;
+    void set_bad_affect(const BossDamageRankingIdData& boss_id_data, uint32_t player_id, BadAffectType type);
+
+    /**
+     * @brief Set a bad affect flag for a character in the damage ranking of a boss.
+     *
+     * @param boss_handle The handle of the boss.
+     * @param player_id The character ID to set the flag for.
+     * @param type The bad affect flag to be set.
+     */
+    void set_bad_affect(const BossDamageRankingHandle& boss_handle, uint32_t player_id, BadAffectType type);
 
     /**
      * @brief Add a boss to the list of bosses tracked by the damage ranking manager.
      *
      * @param boss_data The boss information to add to the list.
+     * @return BossDamageRankingHandle The handle to keep on the boss character, unassigned if the
+     * boss is not ranked.
      */
-    void add_boss_to_list(const BossDamageRankingBossInfo& boss_data);
+    BossDamageRankingHandle add_boss_to_list(const BossDamageRankingBossInfo& boss_data);
 
     /**
      * @brief Erase a boss from the list of bosses tracked by the damage ranking manager.
      *
      * @param boss_id_data The boss ID and mob VID to identify the boss to be erased.
+     * @param fight_end Why the fight ended, stored with the fight result.
+     */
+    void erase_boss_from_list(const BossDamageRankingIdData& boss_id_data,
+        EBossDamageRankingFightEnd fight_end = EBossDamageRankingFightEnd::KILLED);
+
+    /**
+     * @brief Erase a boss from the list of bosses tracked by the damage ranking manager.
+     *
+     * @param boss_handle The handle of the boss to be erased.
+     * @param fight_end Why the fight ended, stored with the fight result.
+     */
+    void erase_boss_from_list(const BossDamageRankingHandle& boss_handle,
+        EBossDamageRankingFightEnd fight_end = EBossDamageRankingFightEnd::KILLED);
+
+    /**
+     * @brief Erase every tracked boss spawned on a map.
+     *
+     * @param map_index The index of the map being torn down.
+     */
+    void erase_bosses_on_map(long map_index);
+
+    /**
+     * @brief Get the counters of the boss registry
+     *
+     * @return BossDamageRankingRegistryStats The registry counters
+     */
+    [[nodiscard]] BossDamageRankingRegistryStats get_registry_stats() const noexcept;
+
+    /**
+     * @brief Get the counters of the ranking broadcasts
+     *
+     * @return const BossDamageRankingBroadcastStats& The broadcast counters
+     */
+    [[nodiscard]] const BossDamageRankingBroadcastStats& get_broadcast_stats() const noexcept;
+
+    /**
+     * @brief Get the call counters and sampled latencies of the hot paths
+     *
+     * @return const BossDamageRankingCallStats& The call counters
+     */
+    [[nodiscard]] const BossDamageRankingCallStats& get_call_stats() const noexcept;
+
+    /**
+     * @brief Reset the broadcast and call counters
+     */
+    void reset_stats() noexcept;
+
+    /**
+     * @brief Format every counter of the manager as text lines, for a GM or the syslog
+     *
+     * @return std::vector<std::string> The report lines
+     */
+    [[nodiscard]] std::vector<std::string> create_stats_report() const;
+
+    /**
+     * @brief Set how often the stats report is written to the syslog
+     *
+     * @param interval The interval in seconds, 0 to turn the periodic report off, clamped to at most an hour
+     */
+    void set_stats_log_interval(uint32_t interval) noexcept;
+
+    /**
+     * @brief Get how often the stats report is written to the syslog
+     *
+     * @return uint32_t The interval in seconds, 0 when the periodic report is off
+     */
+    [[nodiscard]] uint32_t get_stats_log_interval() const noexcept;
+
+    /**
+     * @brief Start recording the ranking activity into the flight recorder
+     *
+     * @param capacity The number of spans kept, the oldest are overwritten
+     */
+    void start_trace(size_t capacity = perfutils::FlightRecorder::default_capacity);
+
+    /**
+     * @brief Stop recording the ranking activity, the recorded spans are kept for a dump
+     */
+    void stop_trace() noexcept;
+
+    /**
+     * @brief Check if the ranking activity is being recorded
+     *
+     * @return bool
+     */
+    [[nodiscard]] bool is_tracing() const noexcept;
+
+    /**
+     * @brief Write the recorded spans as a Chrome/Perfetto trace file
+     *
+     * @param file_name A plain file name, written to the working directory of the core
+     * @return std::optional<size_t> The number of spans written, or std::nullopt if the name was
+     * rejected, nothing was recorded or the file could not be written
+     */
+    [[nodiscard]] std::optional<size_t> dump_trace(const std::string& file_name) const;
+
+    /**
+     * @brief Check if a boss handle still refers to a tracked boss.
+     *
+     * @param boss_handle The handle returned by add_boss_to_list.
+     * @return bool
      */
-    void erase_boss_from_list(const BossDamageRankingIdData& boss_id_data);
+    [[nodiscard]] bool is_boss_tracked(const BossDamageRankingHandle& boss_handle) const noexcept;
+
+    /**
+     * @brief Drop a destroyed character from every ranking it is cached in.
+     *
+     * @param p_character The character being destroyed.
+     *
+     * @details Called from CHARACTER::Destroy, so logouts, warps and disconnects all
+     * end here. The participants keep their damage and are attached again when the
+     * player hits the boss with a new character.
+     */
+    void on_character_destroy(LPCHARACTER p_character);
+
+    /**
+     * @brief Move a character into its current party and guild in every ranking it takes part in.
+     *
+     * @param p_character The character that joined or left a party or guild.
+     *
+     * @details Called from CHARACTER::SetParty and CHARACTER::SetGuild, so the member counts
+     * follow at once instead of on the member's next hit; a party whose leader changed is
+     * renamed on the way. The damage dealt so far stays with the groups the character left.
+     */
+    void on_group_changed(LPCHARACTER p_character);
 
     /**
      * @brief Check if boss is in the ranking
@@ -83,45 +418,284 @@ class CBossDamageRankingManager final : public singleton<CBossDamageRankingManag
      *
      * @param boss_id_data The boss ID and mob VID to send the ranking for.
      */
-    void send_rankings_to_players(const BossDamageRankingIdData& boss_id_data) const;
+    void send_rankings_to_players(const BossDamageRankingIdData& boss_id_data);
 
     /**
-     * @brief Given a sorted vector of player information, creates a vector of
-     * LPCHARACTER objects which can be used to send the rankings to the players.
+     * @brief Given the participant data of a boss, creates the vector of online
+     * characters to send the rankings to, each with its personal damage row.
      *
-     * @param sorted_vec The sorted vector of player information
+     * @param player_data The participant data
+     * @param boss_info The boss information
      *
-     * @return std::vector<LPCHARACTER> The vector of LPCHARACTER objects
+     * @return std::vector<ranking_recipient_t> The recipients and their damage rows
      */
-    static std::vector<LPCHARACTER> get_character_vector_from_sorted_vec(
-        const boss_damage_ranking_player_info_vec_t& sorted_vec);
+    static std::vector<ranking_recipient_t> create_recipient_vector(
+        const CBossDamageRankingPlayerData& player_data, const BossDamageRankingBossInfo& boss_info);
+
+    /**
+     * @brief Create the personal damage row of a participant
+     *
+     * @param damage The damage dealt by the participant
+     * @param boss_info The boss information
+     * @param rank The 1-based rank of the participant
+     * @param participant_count The number of participants of the boss
+     * @param dps The live DPS of the participant
+     *
+     * @return SPacketGCBossDamageRankingDamageInfo The damage row
+     */
+    static SPacketGCBossDamageRankingDamageInfo create_damage_info(uint64_t damage,
+        const BossDamageRankingBossInfo& boss_info,
+        uint32_t rank,
+        size_t participant_count,
+        uint64_t dps);
 
     /**
      * @brief Create a vector of packet information for the boss damage ranking
      *
-     * @param sorted_vec The sorted vector of player information
+     * @param player_data The participant data holding the top ranking
+     * @param boss_info The boss information, used to compute the damage percents
      *
      * @return std::vector<SPacketGCBossDamageRankingInfo> The vector of packet
      * information
+     *
+     * @details The only place the names and races of the side table are read.
      */
     static std::vector<SPacketGCBossDamageRankingInfo> create_ranking_info_vector(
-        const boss_damage_ranking_player_info_vec_t& sorted_vec);
+        const CBossDamageRankingPlayerData& player_data, const BossDamageRankingBossInfo& boss_info);
+
+    /**
+     * @brief Create the party and guild top rankings of a boss
+     *
+     * @param player_data The participant data holding the groups
+     * @param boss_info The boss information, used to compute the damage percents
+     *
+     * @return boss_damage_ranking_group_ranking_vec_t The rankings of the group types with at least one group
+     */
+    static boss_damage_ranking_group_ranking_vec_t create_group_ranking_vector(
+        const CBossDamageRankingPlayerData& player_data, const BossDamageRankingBossInfo& boss_info);
+
+    /**
+     * @brief Serialize the full top ranking once for every recipient of a broadcast
+     *
+     * @param boss_vid The VID of the boss
+     * @param version The ranking version
+     * @param info_vec The vector of top ranking information
+     * @param group_ranking_vec The group rankings appended after the top ranking
+     *
+     * @return networkutils::shared_packet_t The serialized ranking packet
+     */
+    static networkutils::shared_packet_t create_ranking_packet(uint32_t boss_vid,
+        uint32_t version,
+        const std::vector<SPacketGCBossDamageRankingInfo>& info_vec,
+        const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec = {});
+
+    /**
+     * @brief Serialize the changed top ranking rows once for every recipient of a broadcast
+     *
+     * @param boss_vid The VID of the boss
+     * @param base_version The ranking version the delta applies to
+     * @param version The ranking version after the delta
+     * @param info_vec The vector of top ranking information
+     * @param row_mask_vec The changed fields of each row
+     * @param group_ranking_vec The changed group rankings appended after the delta
+     *
+     * @return networkutils::shared_packet_t The serialized delta packet
+     */
+    static networkutils::shared_packet_t create_ranking_delta_packet(uint32_t boss_vid,
+        uint32_t base_version,
+        uint32_t version,
+        const std::vector<SPacketGCBossDamageRankingInfo>& info_vec,
+        const std::vector<uint8_t>& row_mask_vec,
+        const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec = {});
+
+    /**
+     * @brief Compare the top ranking with the last broadcast rows and remember it as broadcast
+     *
+     * @param sent_rows The last broadcast rows, updated to the current ranking
+     * @param player_data The participant data holding the current top ranking
+     * @param info_vec The packet information of the current top ranking
+     *
+     * @return std::vector<uint8_t> The changed EBossDamageRankingRowField bits of each row
+     */
+    static std::vector<uint8_t> update_sent_rows(std::pmr::vector<BossDamageRankingRowState>& sent_rows,
+        const CBossDamageRankingPlayerData& player_data,
+        const std::vector<SPacketGCBossDamageRankingInfo>& info_vec);
+
+    /**
+     * @brief Compare the group rankings with the last broadcast rows and remember them as broadcast
+     *
+     * @param boss_data The boss data holding the last broadcast group rows
+     * @param group_ranking_vec The current group rankings
+     *
+     * @return boss_damage_ranking_group_ranking_vec_t The group rankings with at least one changed row
+     */
+    static boss_damage_ranking_group_ranking_vec_t update_sent_group_rows(
+        CBossDamageRankingBossData& boss_data, const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec);
 
     /**
      * @brief Send boss damage rankings to a character
      *
      * @param p_character The character to which the rankings should be sent
-     * @param info_vec The vector of ranking information to be sent
+     * @param ranking_packet The serialized top ranking or delta, shared by every recipient
+     * @param damage_info The personal damage row of the character
      */
-    static void send_ranking_to_player(
-        LPCHARACTER p_character, const std::vector<SPacketGCBossDamageRankingInfo>& info_vec);
+    void send_ranking_to_player(LPCHARACTER p_character,
+        const networkutils::shared_packet_t& ranking_packet,
+        const SPacketGCBossDamageRankingDamageInfo& damage_info);
 
     /**
-     * @brief Reload the boss damage ranking manager from the database
+     * @brief Reload the boss damage ranking manager from the database, on this core and its peers
      */
     void reload() noexcept;
 
+    /**
+     * @brief Destroy the CBossDamageRankingManager object, queueing the pending fight results
+     */
+    ~CBossDamageRankingManager();
+
+    /**
+     * @brief Run the periodic work of the manager, called from the game heartbeat.
+     *
+     * @param pulse The current game pulse.
+     */
+    void update(int pulse);
+
+    /**
+     * @brief Set the minimum time between two ranking broadcasts of bosses whose row leaves broadcast_interval_ms NULL
+     *
+     * @param interval The broadcast interval in milliseconds
+     */
+    void set_broadcast_interval(uint32_t interval) noexcept;
+
+    /**
+     * @brief Set the top ranking size of newly spawned bosses whose row leaves top_n NULL
+     *
+     * @param top_limit The top ranking size
+     */
+    void set_top_limit(uint8_t top_limit) noexcept;
+
+    /**
+     * @brief Choose whether the rankings are computed on a worker thread, read once by initialize()
+     *
+     * @param enabled True to start the worker thread
+     *
+     * @details With the worker the game thread only validates the hits and queues them;
+     * the arenas of its fights are not counted in the allocation stats.
+     */
+    void set_worker_thread(bool enabled) noexcept;
+
+    /**
+     * @brief Wait until the worker applied every queued event and send what it prepared
+     *
+     * @details Game thread only, for tools that read the stats such as the bench; the
+     * game never waits for the worker.
+     */
+    void wait_for_worker();
+
+    /**
+     * @brief Set the directory the event logs of killed bosses are written to
+     *
+     * @param directory The directory, empty to record no event log
+     *
+     * @details Read when a boss spawns, so bosses already tracked keep their setting.
+     */
+    void set_event_log_dir(std::string directory);
+
+    /**
+     * @brief Set the number of hits and bad affects kept in the event log of each boss
+     *
+     * @param capacity The number of events, rounded up to a power of two
+     */
+    void set_event_log_capacity(uint32_t capacity) noexcept;
+
+    /**
+     * @brief Get the allocation counters of the boss records and the per-fight arenas
+     *
+     * @return BossDamageRankingAllocationStats The allocation counters
+     */
+    [[nodiscard]] BossDamageRankingAllocationStats get_allocation_stats() const noexcept;
+
   private:
+    /**
+     * @brief Append one BOSS_DMG_RANKING_GROUP_INFO packet per group ranking
+     *
+     * @param packet_builder The builder holding the ranking packet
+     * @param boss_vid The VID of the boss
+     * @param group_ranking_vec The group rankings
+     */
+    static void add_group_rankings(networkutils::shared_packet_builder_t& packet_builder,
+        uint32_t boss_vid,
+        const boss_damage_ranking_group_ranking_vec_t& group_ranking_vec);
+
+    /**
+     * @brief Build a config snapshot from the result of the boss_dmg_ranking query
+     *
+     * @param p_msg The query result
+     * @return std::optional<BossDamageRankingConfig> The snapshot, or std::nullopt if the query failed
+     */
+    [[nodiscard]] static std::optional<BossDamageRankingConfig> create_config(SQLMsg* p_msg);
+
+    /**
+     * @brief Build a config snapshot from the settings of the ranked bosses
+     *
+     * @param boss_settings_vec The settings of the ranked bosses, in any order
+     * @return BossDamageRankingConfig The snapshot
+     */
+    [[nodiscard]] static BossDamageRankingConfig create_config(
+        std::vector<BossDamageRankingBossSettings> boss_settings_vec);
+
+    /**
+     * @brief Serialize a config snapshot into a HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING packet
+     *
+     * @param config The config snapshot
+     * @param sub_header CONFIG for a reload, RESYNC_CONFIG for the answer to a resync request
+     * @return std::vector<uint8_t> The packet, fixed part and boss settings
+     */
+    [[nodiscard]] static std::vector<uint8_t> create_config_packet(
+        const BossDamageRankingConfig& config, EPacketGGBossDamageRankingSubHeaderType sub_header);
+
+    /**
+     * @brief Hash the boss settings of a config packet
+     *
+     * @param p_data The serialized boss settings
+     * @param size The number of bytes
+     * @return uint32_t The FNV-1a hash
+     */
+    [[nodiscard]] static uint32_t calc_config_checksum(const uint8_t* p_data, size_t size) noexcept;
+
+    /**
+     * @brief Build the checksum announcement of a config snapshot
+     *
+     * @param config The config snapshot
+     * @return SPacketGGBossDamageRankingConfig The fixed part of its config packet, without the boss settings
+     */
+    [[nodiscard]] static SPacketGGBossDamageRankingConfig create_config_checksum_packet(
+        const BossDamageRankingConfig& config);
+
+    /**
+     * @brief Keep the snapshot of an asynchronous config load for the next pulse
+     *
+     * @param request_id The ID of the load request.
+     * @param loaded_at The time the load was requested.
+     * @param share_with_peers Whether the snapshot is sent to the other cores.
+     * @param p_msg The query result.
+     */
+    void on_config_loaded(uint32_t request_id, uint32_t loaded_at, bool share_with_peers, SQLMsg* p_msg);
+
+    /**
+     * @brief Get the newest config snapshot, published or waiting for the next pulse
+     *
+     * @return const BossDamageRankingConfig& The config snapshot
+     */
+    [[nodiscard]] const BossDamageRankingConfig& get_latest_config() const noexcept;
+
+    /**
+     * @brief Publish a config snapshot and tear down the bosses it no longer ranks
+     *
+     * @param config The new config snapshot.
+     */
+    void publish_config(boss_damage_ranking_config_t config);
+
     /**
      * @brief Check boss is valid
      *
@@ -130,17 +704,24 @@ class CBossDamageRankingManager final : public singleton<CBossDamageRankingManag
      */
     [[nodiscard]] bool check_valid_boss(const BossDamageRankingIdData& boss_id_data) const;
 
+    /**
+     * @brief Send the boss damage ranking to all players that are currently logged in and in the ranking.
+     *
+     * @param boss_data The boss data object.
+     */
+    void send_rankings_to_players(CBossDamageRankingBossData* boss_data);
+
     /**
      * @brief Create a container with the ranking information and characters for a boss
      *
-     * @param boss_id_data The id data of the boss for which the container should be created
+     * @param boss_data The boss data for which the container should be created
      *
-     * @return std::tuple<std::vector<SPacketGCBossDamageRankingInfo>, std::vector<LPCHARACTER>>
-     * A tuple containing the ranking information and characters for the boss
+     * @return std::tuple<RankingPackets, std::vector<ranking_recipient_t>>
+     * A tuple containing the serialized top ranking and the recipients for the boss
      *
-     * @throws std::runtime_error If the boss info is not found
+     * @details Starts a new ranking version; every returned recipient is recorded as holding it.
      */
-    std::optional<ranking_container_t> create_ranking_container(const BossDamageRankingIdData& boss_id_data) const;
+    ranking_container_t create_ranking_container(CBossDamageRankingBossData* boss_data);
 
     /**
      * @brief Retrieve boss information based on boss ID and mob VID.
@@ -154,31 +735,306 @@ class CBossDamageRankingManager final : public singleton<CBossDamageRankingManag
     [[nodiscard]] std::optional<CBossDamageRankingBossData*> get_boss_info(
         const BossDamageRankingIdData& boss_id_data) const;
 
+    /**
+     * @brief Find the slot of a tracked boss through the VID index.
+     *
+     * @param boss_id_data The boss ID and mob VID to look up.
+     * @return std::optional<boss_slot_t> The boss slot, or std::nullopt if the VID is not tracked
+     * or now belongs to another mob vnum.
+     */
+    [[nodiscard]] std::optional<boss_slot_t> find_boss_slot(const BossDamageRankingIdData& boss_id_data) const noexcept;
+
+    /**
+     * @brief Free a boss slot and drop its VID from the index.
+     *
+     * @param boss_slot The slot to free.
+     * @return boss_damage_ranking_boss_data_t The record the slot held
+     */
+    boss_damage_ranking_boss_data_t release_boss_slot(boss_slot_t boss_slot);
+
+    /**
+     * @brief Send the final ranking of a tracked boss if needed, persist the fight and free its slot.
+     *
+     * @param boss_slot The slot of a tracked boss.
+     * @param fight_end Why the fight ended.
+     */
+    void erase_boss_slot(boss_slot_t boss_slot, EBossDamageRankingFightEnd fight_end);
+
+    /**
+     * @brief Queue the result of a finished fight for the next batched write.
+     *
+     * @param boss_data The boss data object.
+     * @param fight_end Why the fight ended.
+     *
+     * @details One row for the fight and one per participant; fights nobody damaged are skipped.
+     */
+    void persist_fight(CBossDamageRankingBossData* boss_data, EBossDamageRankingFightEnd fight_end);
+
+    /**
+     * @brief Write the event log of a killed boss to the event log directory.
+     *
+     * @param boss_data The boss data object.
+     * @param fight_end Why the fight ended.
+     *
+     * @details Only kills are written; a fight without events writes nothing.
+     */
+    void write_event_log(CBossDamageRankingBossData* boss_data, EBossDamageRankingFightEnd fight_end) const;
+
+    /**
+     * @brief Queue the pending fight result statements on the asynchronous DB queue.
+     */
+    void flush_fight_results();
+
+    /**
+     * @brief Queue a hit of a character for the worker thread, with its profile on its first hit.
+     *
+     * @param p_character The character pointer.
+     * @param boss_handle The handle of the boss.
+     * @param damage The amount of damage dealt to the boss, 0 to only join the ranking.
+     */
+    void queue_damage_event(LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle, uint64_t damage);
+
+    /**
+     * @brief Queue the profile of a character for the worker thread, with its current groups.
+     *
+     * @param p_character The character pointer.
+     * @param group_ids The IDs returned by get_group_ids.
+     */
+    void queue_online_profile(LPCHARACTER p_character, const boss_damage_ranking_group_ids_t& group_ids);
+
+    /**
+     * @brief Send the rankings prepared by the worker thread and persist the bosses it gave back.
+     *
+     * @param send_rankings False to drop the rankings, when shutting down
+     */
+    void dispatch_worker_results(bool send_rankings);
+
+    /**
+     * @brief Stop the worker thread once it applied every queued event
+     */
+    void stop_worker();
+
+    /**
+     * @brief Erase the tracked bosses whose mob no longer exists.
+     *
+     * @details Safety net for the destroy paths that do not reach the registry: a boss
+     * is reaped when its VID no longer resolves to a living mob of the same vnum.
+     */
+    void reap_bosses();
+
+    /**
+     * @brief Resolve a boss handle to its tracker.
+     *
+     * @param boss_handle The handle returned by add_boss_to_list.
+     * @return CBossDamageRankingBossData* The boss data, or nullptr if the handle is unassigned or stale.
+     */
+    [[nodiscard]] CBossDamageRankingBossData* resolve_boss(const BossDamageRankingHandle& boss_handle) const noexcept;
+
+    /**
+     * @brief Build the handle of a tracked boss from its ID data.
+     *
+     * @param boss_id_data The boss ID and mob VID to look up.
+     * @return BossDamageRankingHandle The boss handle, unassigned if the boss is not tracked.
+     */
+    [[nodiscard]] BossDamageRankingHandle get_boss_handle(const BossDamageRankingIdData& boss_id_data) const noexcept;
+
     /**
      * @brief
      * @param p_character
-     * @param boss_id_data
+     * @param boss_handle
      * @return
      */
     std::optional<validate_data_t> validate_and_get_data(
-        LPCHARACTER p_character, const BossDamageRankingIdData& boss_id_data) const;
+        LPCHARACTER p_character, const BossDamageRankingHandle& boss_handle) const;
 
     /**
-     * @brief
-     * @param player_data
-     * @param p_character
+     * @brief Find the participant slot of a character, adding it to the damage list if needed.
+     *
+     * @param boss_data The boss data object.
+     * @param player_data The player data object.
+     * @param p_character The character pointer.
+     * @param boss_handle The handle of the boss.
+     * @return std::optional<player_slot_t> The participant slot, or std::nullopt if the character is invalid.
+     *
+     * @details A character that joins the ranking gets the current ranking right away instead of
+     * waiting for the next broadcast. A participant coming back with a new character is attached
+     * to it again.
+     */
+    std::optional<player_slot_t> ensure_player_in_ranking(CBossDamageRankingBossData* boss_data,
+        CBossDamageRankingPlayerData* player_data,
+        LPCHARACTER p_character,
+        const BossDamageRankingHandle& boss_handle);
+
+    /**
+     * @brief Remember that a character is cached as a participant of a boss.
+     *
+     * @param player_id The player ID of the character.
+     * @param boss_handle The handle of the boss.
+     * @param player_slot The participant slot of the character.
+     *
+     * @details References to bosses that are gone are dropped on the way.
+     */
+    void add_participant_ref(uint32_t player_id, const BossDamageRankingHandle& boss_handle, player_slot_t player_slot);
+
+    /**
+     * @brief Queue a boss for the next ranking broadcast.
+     *
+     * @param boss_data The boss data object.
+     * @param boss_handle The handle of the boss.
+     */
+    void mark_boss_dirty(CBossDamageRankingBossData* boss_data, const BossDamageRankingHandle& boss_handle);
+
+    /**
+     * @brief Broadcast the rankings of the bosses that changed since their last broadcast.
+     *
+     * @details A boss is broadcast at most once per broadcast interval; bosses still inside
+     * their interval stay queued for a later pulse.
+     */
+    void flush_rankings();
+
+    /**
+     * @brief Slab pool of the boss records, declared before the records so it outlives them
+     */
+    memutils::ObjectPool<CBossDamageRankingBossData> m_boss_pool{};
+
+    /**
+     * @brief Upstream of every per-fight arena, counts the arena blocks
      */
-    static void ensure_player_in_ranking(CBossDamageRankingPlayerData* player_data, LPCHARACTER p_character);
+    memutils::CountingResource m_arena_upstream{};
 
     /**
-     * @brief Vector of boss damage ranking boss data
+     * @brief Vector of boss damage ranking boss data, indexed by boss slot; freed slots hold nullptr
      */
     boss_damage_ranking_vec_t m_boss_info_vec{};
 
     /**
-     * @brief Set of boss vnums
+     * @brief Freed slots of m_boss_info_vec, reused by add_boss_to_list
+     */
+    std::vector<boss_slot_t> m_free_boss_slot_vec{};
+
+    /**
+     * @brief Generation of each boss slot, bumped whenever the slot is freed
+     */
+    std::vector<uint32_t> m_boss_generation_vec{};
+
+    /**
+     * @brief Boss VID to boss slot index
+     */
+    hashutils::FlatIndex<uint32_t> m_boss_index{};
+
+    /**
+     * @brief Player ID to the participant slots its online character is cached in
+     */
+    std::unordered_map<uint32_t, std::vector<ParticipantRef>> m_participant_ref_map{};
+
+    /**
+     * @brief Characters whose profile was queued for the worker, indexed by recipient slot; freed slots hold nullptr
+     */
+    std::vector<LPCHARACTER> m_recipient_vec{};
+
+    /**
+     * @brief Freed slots of m_recipient_vec, reused by queue_online_profile
+     */
+    std::vector<uint32_t> m_free_recipient_slot_vec{};
+
+    /**
+     * @brief Published config snapshot, never null
+     */
+    boss_damage_ranking_config_t m_config{std::make_shared<const BossDamageRankingConfig>()};
+
+    /**
+     * @brief Loaded config snapshot waiting for the next pulse, null if none
+     */
+    boss_damage_ranking_config_t m_pending_config{};
+
+    /**
+     * @brief ID of the latest asynchronous config load
+     */
+    uint32_t m_config_request_id{};
+
+    /**
+     * @brief Number of players kept in the top ranking of each boss
+     */
+    uint8_t m_top_limit{default_top_limit};
+
+    /**
+     * @brief Bosses whose ranking changed since their last broadcast
+     */
+    std::vector<BossDamageRankingHandle> m_dirty_boss_vec{};
+
+    /**
+     * @brief Minimum time between two ranking broadcasts of the same boss, in milliseconds
+     */
+    uint32_t m_broadcast_interval{default_broadcast_interval};
+
+    /**
+     * @brief Bosses erased on death, destruction or map teardown
+     */
+    uint64_t m_erased_boss_count{};
+
+    /**
+     * @brief Leaked bosses found and erased by the reaper
+     */
+    uint64_t m_reaped_boss_count{};
+
+    /**
+     * @brief Counters of the ranking broadcasts
+     */
+    BossDamageRankingBroadcastStats m_broadcast_stats{};
+
+    /**
+     * @brief Call counters and sampled latencies of the hot paths
+     */
+    BossDamageRankingCallStats m_call_stats{};
+
+    /**
+     * @brief Seconds between two stats reports in the syslog, 0 for none
+     */
+    uint32_t m_stats_log_interval{};
+
+    /**
+     * @brief Opt-in recorder of the latest spans of ranking activity
+     */
+    perfutils::FlightRecorder m_flight_recorder{};
+
+    /**
+     * @brief Pending rows of boss_dmg_ranking_fight
+     */
+    dbutils::BatchedInsert m_fight_insert{
+        "INSERT INTO boss_dmg_ranking_fight (channel, map_index, boss_vid, spawn_time, boss_vnum, end_time, "
+        "end_reason, max_hp, participant_count) VALUES "};
+
+    /**
+     * @brief Pending rows of boss_dmg_ranking_fight_participant
+     */
+    dbutils::BatchedInsert m_participant_insert{
+        "INSERT INTO boss_dmg_ranking_fight_participant (channel, map_index, boss_vid, spawn_time, player_id, "
+        "damage, percent_damage, bad_affect_flag) VALUES "};
+
+    /**
+     * @brief Directory of the event logs, empty when no event log is recorded
+     */
+    std::string m_event_log_dir{};
+
+    /**
+     * @brief Hits and bad affects kept in the event log of each boss
+     */
+    uint32_t m_event_log_capacity{default_event_log_capacity};
+
+    /**
+     * @brief Whether initialize() starts the worker thread
+     */
+    bool m_use_worker_thread{};
+
+    /**
+     * @brief Worker thread owning the ranking state, null when the rankings run on the game thread
+     */
+    std::unique_ptr<CBossDamageRankingWorker> mp_worker{};
+
+    /**
+     * @brief Erased bosses the worker still holds, in erase order
      */
-    std::unordered_set<uint32_t> m_set_boss_vnum{};
+    std::deque<RetiringBoss> m_retiring_boss_deque{};
 };
 
 /**
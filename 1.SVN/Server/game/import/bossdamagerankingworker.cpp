@@ -0,0 +1,654 @@
+/*
+ * ? Author: LWT
+ * * Description: Ranking worker thread, fed by the game thread through lock-free rings.
+ */
+#include "stdafx.h"
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+#include "bossdamagerankingworker.hpp"
+#include "bossdamagerankingmanager.hpp"
+
+namespace bossdamageranking {
+
+namespace {
+
+/**
+ * @brief Events applied before the worker hands the dispatches kept aside to the game thread again
+ */
+constexpr size_t event_batch_size{4096U};
+
+/**
+ * @brief Sleep of the worker when no event is queued, far below any broadcast interval
+ */
+constexpr std::chrono::milliseconds idle_sleep{1};
+
+} // namespace
+
+/**
+ * @brief Construct a new CBossDamageRankingWorker object and start its thread
+ */
+CBossDamageRankingWorker::CBossDamageRankingWorker()
+{
+    m_thread = std::thread{&CBossDamageRankingWorker::run, this};
+}
+
+/**
+ * @brief Destroy the CBossDamageRankingWorker object, joining its thread
+ */
+CBossDamageRankingWorker::~CBossDamageRankingWorker()
+{
+    request_stop();
+
+    if (m_thread.joinable()) { m_thread.join(); }
+}
+
+/**
+ * @brief Queue an event, game thread only
+ *
+ * @param event The event
+ *
+ * @details Never waits for the worker. While the ring is full, a boss or player
+ * event or a PULSE is kept aside in order, and a hit is dropped with its damage
+ * folded into one resent hit per boss and player.
+ */
+void CBossDamageRankingWorker::push_event(const BossDamageRankingEvent& event)
+{
+    if (!m_pending_event_deque.empty() || !m_lost_damage_map.empty()) [[unlikely]] { flush_pending_events(); }
+
+    switch (event.type)
+    {
+    case EBossDamageRankingEventType::DAMAGE:
+    case EBossDamageRankingEventType::BAD_AFFECT:
+    {
+        // a hit queued before an older boss or player event could miss its boss or profile
+        if (m_pending_event_deque.empty())
+        {
+            auto queued_event{event};
+            queued_event.time = get_dword_time();
+
+            if (m_event_queue.try_push(queued_event))
+            {
+                ++m_event_count;
+                return;
+            }
+        }
+
+        ++m_dropped_event_count;
+
+        // a bad affect is set again by the next tick of its DoT
+        if (EBossDamageRankingEventType::DAMAGE != event.type) { return; }
+
+        const auto lost_damage_key{static_cast<uint64_t>(event.boss_handle.slot) << 32U | event.player_id};
+        const auto [lost_damage_iter, inserted]{m_lost_damage_map.try_emplace(lost_damage_key, event)};
+
+        if (!inserted) { lost_damage_iter->second.amount += event.amount; }
+
+        return;
+    }
+
+    case EBossDamageRankingEventType::PULSE:
+    {
+        // one pulse waiting behind the others flushes the rankings just as well
+        if (!m_pending_event_deque.empty() &&
+            EBossDamageRankingEventType::PULSE == m_pending_event_deque.back().event.type)
+        {
+            return;
+        }
+
+        queue_control_event({event, {}, false});
+        return;
+    }
+
+    case EBossDamageRankingEventType::ERASE_BOSS:
+    case EBossDamageRankingEventType::PLAYER_OFFLINE:
+    {
+        if (!m_lost_damage_map.empty()) { queue_lost_damage(event); }
+
+        queue_control_event({event, {}, false});
+        return;
+    }
+
+    default:
+    {
+        queue_control_event({event, {}, false});
+        return;
+    }
+    }
+}
+
+/**
+ * @brief Queue a PLAYER_ONLINE event with the profile shown in the rankings, game thread only
+ *
+ * @param player_id The player ID
+ * @param online_profile The name, race, party and guild of the player
+ *
+ * @details Queued again when the player joins or leaves a party or guild; the
+ * newer profile replaces the older one.
+ */
+void CBossDamageRankingWorker::push_player_online(
+    const uint32_t player_id, const BossDamageRankingOnlineProfile& online_profile)
+{
+    if (!m_pending_event_deque.empty() || !m_lost_damage_map.empty()) [[unlikely]] { flush_pending_events(); }
+
+    BossDamageRankingEvent event{};
+    event.type = EBossDamageRankingEventType::PLAYER_ONLINE;
+    event.player_id = player_id;
+    queue_control_event({event, online_profile, false});
+}
+
+/**
+ * @brief Move the events kept aside and the folded damage into the rings, game thread only
+ *
+ * @return bool True once nothing is left aside
+ *
+ * @details The folded damage goes last, after the boss and player events it may need.
+ */
+bool CBossDamageRankingWorker::flush_pending_events()
+{
+    while (!m_pending_event_deque.empty())
+    {
+        if (!try_queue_event(m_pending_event_deque.front())) { return false; }
+
+        m_pending_event_deque.pop_front();
+    }
+
+    for (auto lost_damage_iter{m_lost_damage_map.begin()}; m_lost_damage_map.end() != lost_damage_iter;)
+    {
+        auto event{lost_damage_iter->second};
+        event.time = get_dword_time();
+
+        if (!m_event_queue.try_push(event)) { return false; }
+
+        ++m_event_count;
+        lost_damage_iter = m_lost_damage_map.erase(lost_damage_iter);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Move an event into the ring, publishing the profile of PLAYER_ONLINE first, game thread only
+ *
+ * @param pending The event, left as is if the ring is full
+ * @return bool False if the ring is full
+ *
+ * @details The event is stamped with the game time when it enters the ring, so the
+ * worker's clock never goes back.
+ */
+bool CBossDamageRankingWorker::try_queue_event(PendingEvent& pending)
+{
+    // the profile is published before its event, so the worker always finds it
+    if (EBossDamageRankingEventType::PLAYER_ONLINE == pending.event.type && !pending.is_profile_published)
+    {
+        if (!m_profile_queue.try_push(pending.online_profile)) { return false; }
+
+        pending.is_profile_published = true;
+    }
+
+    pending.event.time = get_dword_time();
+
+    if (!m_event_queue.try_push(pending.event)) { return false; }
+
+    ++m_event_count;
+
+    return true;
+}
+
+/**
+ * @brief Queue a boss, player or PULSE event, keeping it aside behind the older ones while the ring is full
+ *
+ * @param pending The event
+ *
+ * @details These events are never dropped: a lost boss would never be given back, a
+ * lost profile would hide the player's rankings.
+ */
+void CBossDamageRankingWorker::queue_control_event(PendingEvent pending)
+{
+    if (m_pending_event_deque.empty() && try_queue_event(pending)) { return; }
+
+    m_pending_event_deque.emplace_back(std::move(pending));
+}
+
+/**
+ * @brief Queue the folded damage that must be applied before a boss is erased or a player goes offline
+ *
+ * @param event The ERASE_BOSS or PLAYER_OFFLINE event about to be queued
+ *
+ * @details Keeps the final ranking of the boss whole, and the player in it under its name.
+ */
+void CBossDamageRankingWorker::queue_lost_damage(const BossDamageRankingEvent& event)
+{
+    const auto is_boss_erased{EBossDamageRankingEventType::ERASE_BOSS == event.type};
+
+    for (auto lost_damage_iter{m_lost_damage_map.begin()}; m_lost_damage_map.end() != lost_damage_iter;)
+    {
+        const auto& lost_damage{lost_damage_iter->second};
+
+        if (is_boss_erased ? lost_damage.boss_handle.slot != event.boss_handle.slot
+                           : lost_damage.player_id != event.player_id)
+        {
+            ++lost_damage_iter;
+            continue;
+        }
+
+        queue_control_event({lost_damage, {}, false});
+        lost_damage_iter = m_lost_damage_map.erase(lost_damage_iter);
+    }
+}
+
+/**
+ * @brief Take the oldest prepared dispatch, game thread only
+ *
+ * @param dispatch Receives the dispatch
+ * @return bool False if none is ready
+ */
+bool CBossDamageRankingWorker::pop_dispatch(BossDamageRankingDispatch& dispatch)
+{
+    return m_dispatch_queue.try_pop(dispatch);
+}
+
+/**
+ * @brief Ask the thread to stop once every queued event is applied
+ */
+void CBossDamageRankingWorker::request_stop() noexcept { m_stop_requested.store(true, std::memory_order_release); }
+
+/**
+ * @brief Check if the thread is still applying events
+ *
+ * @return bool False once it stopped after request_stop
+ */
+bool CBossDamageRankingWorker::is_running() const noexcept { return m_running.load(std::memory_order_acquire); }
+
+/**
+ * @brief Get the number of events the game thread moved into the ring
+ */
+uint64_t CBossDamageRankingWorker::get_event_count() const noexcept { return m_event_count; }
+
+/**
+ * @brief Get the number of events the worker applied, any thread
+ */
+uint64_t CBossDamageRankingWorker::get_applied_event_count() const noexcept
+{
+    return m_applied_event_count.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Get the number of hits the game thread dropped on a full ring, their damage is resent
+ */
+uint64_t CBossDamageRankingWorker::get_dropped_event_count() const noexcept { return m_dropped_event_count; }
+
+/**
+ * @brief Get the number of events kept aside and folded hits waiting for room in the ring
+ */
+size_t CBossDamageRankingWorker::get_pending_event_count() const noexcept
+{
+    return m_pending_event_deque.size() + m_lost_damage_map.size();
+}
+
+/**
+ * @brief Get the number of participants of the bosses held by the worker
+ */
+size_t CBossDamageRankingWorker::get_participant_count() const noexcept
+{
+    return m_participant_count.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Body of the worker thread
+ *
+ * @details Events are applied in batches. The dirty bosses are serialized when a PULSE
+ * is applied, so the broadcasts follow the game pulses as without the worker, however
+ * far the worker lags behind. A stop request is only honoured once the rings are
+ * empty, so every event pushed before it is applied and handed back.
+ */
+void CBossDamageRankingWorker::run()
+{
+    BossDamageRankingEvent event{};
+
+    while (true)
+    {
+        const auto stop_requested{m_stop_requested.load(std::memory_order_acquire)};
+
+        flush_pending_dispatches();
+
+        size_t event_count{};
+
+        while (event_count < event_batch_size && m_event_queue.try_pop(event))
+        {
+            process_event(event);
+            ++event_count;
+        }
+
+        if (0U != event_count)
+        {
+            m_applied_event_count.fetch_add(event_count, std::memory_order_release);
+            continue;
+        }
+
+        if (stop_requested && m_pending_dispatch_deque.empty()) { break; }
+
+        std::this_thread::sleep_for(idle_sleep);
+    }
+
+    m_running.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief Apply one event
+ *
+ * @param event The event
+ */
+void CBossDamageRankingWorker::process_event(const BossDamageRankingEvent& event)
+{
+    m_now = event.time;
+
+    switch (event.type)
+    {
+    case EBossDamageRankingEventType::ADD_BOSS:
+    {
+        if (event.boss_handle.slot >= m_boss_vec.size()) { m_boss_vec.resize(event.boss_handle.slot + 1U); }
+
+        m_boss_vec[event.boss_handle.slot] = {event.p_boss_data, event.boss_handle.generation};
+        break;
+    }
+
+    case EBossDamageRankingEventType::ERASE_BOSS:
+    {
+        auto* const boss_data{resolve_boss(event.boss_handle)};
+
+        if (nullptr == boss_data) { break; }
+
+        // the final ranking goes out right away, whatever the broadcast interval
+        if (boss_data->is_dirty()) { prepare_broadcast(boss_data); }
+
+        m_participant_count.fetch_sub(boss_data->get_player_data()->get_player_count(), std::memory_order_relaxed);
+        m_boss_vec[event.boss_handle.slot] = {};
+
+        BossDamageRankingDispatch dispatch{};
+        dispatch.p_retired_boss = boss_data;
+        push_dispatch(std::move(dispatch));
+        break;
+    }
+
+    case EBossDamageRankingEventType::PLAYER_ONLINE:
+    {
+        BossDamageRankingOnlineProfile online_profile{};
+
+        if (!m_profile_queue.try_pop(online_profile)) { break; }
+
+        // queued again after a party or guild change: the member counts follow at once
+        for (uint32_t boss_slot{}; boss_slot < m_boss_vec.size(); ++boss_slot)
+        {
+            const auto& worker_boss{m_boss_vec[boss_slot]};
+
+            if (nullptr == worker_boss.p_boss_data) { continue; }
+
+            auto* const player_data{worker_boss.p_boss_data->get_player_data()};
+            const auto player_slot{player_data->find_player_slot(event.player_id)};
+
+            if (std::nullopt != player_slot && player_data->set_groups(player_slot.value(), online_profile.group_profiles))
+            {
+                mark_boss_dirty(worker_boss.p_boss_data, {boss_slot, worker_boss.generation});
+            }
+        }
+
+        m_profile_map[event.player_id] = std::move(online_profile);
+        break;
+    }
+
+    case EBossDamageRankingEventType::PLAYER_OFFLINE:
+    {
+        m_profile_map.erase(event.player_id);
+        break;
+    }
+
+    case EBossDamageRankingEventType::DAMAGE:
+    {
+        auto* const boss_data{resolve_boss(event.boss_handle)};
+
+        if (nullptr == boss_data) { break; }
+
+        const auto player_slot{ensure_player_in_ranking(boss_data, event.player_id)};
+
+        if (std::nullopt == player_slot) { break; }
+
+        boss_data->get_player_data()->add_damage(player_slot.value(), event.amount, m_now);
+
+        if (auto& event_log{boss_data->get_event_log()}; event_log.is_enabled() && 0U != event.amount) [[unlikely]]
+        {
+            event_log.record(m_now, player_slot.value(), event.amount, 0U);
+        }
+
+        mark_boss_dirty(boss_data, event.boss_handle);
+        break;
+    }
+
+    case EBossDamageRankingEventType::BAD_AFFECT:
+    {
+        auto* const boss_data{resolve_boss(event.boss_handle)};
+
+        // the game thread already dropped the flags of bosses that do not track them
+        if (nullptr == boss_data) { break; }
+
+        const auto player_slot{
+            boss_data->get_player_data()->set_bad_affect_flag(event.player_id, static_cast<BadAffectType>(event.flags))};
+
+        if (auto& event_log{boss_data->get_event_log()}; event_log.is_enabled() && player_slot.has_value()) [[unlikely]]
+        {
+            event_log.record(m_now, player_slot.value(), 0U, event.flags);
+        }
+
+        mark_boss_dirty(boss_data, event.boss_handle);
+        break;
+    }
+
+    case EBossDamageRankingEventType::PULSE:
+    {
+        flush_rankings();
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Resolve a boss handle to a boss held by the worker
+ *
+ * @param boss_handle The handle
+ * @return CBossDamageRankingBossData* The boss data, or nullptr if the boss was erased
+ */
+CBossDamageRankingBossData* CBossDamageRankingWorker::resolve_boss(
+    const BossDamageRankingHandle& boss_handle) const noexcept
+{
+    if (boss_handle.slot >= m_boss_vec.size()) { return nullptr; }
+
+    const auto& worker_boss{m_boss_vec[boss_handle.slot]};
+
+    if (worker_boss.generation != boss_handle.generation) { return nullptr; }
+
+    return worker_boss.p_boss_data;
+}
+
+/**
+ * @brief Find the participant slot of a player, adding it and preparing its first ranking if needed
+ *
+ * @param boss_data The boss data object
+ * @param player_id The player ID
+ * @return std::optional<player_slot_t> The participant slot, or std::nullopt if the fight is full
+ */
+std::optional<player_slot_t> CBossDamageRankingWorker::ensure_player_in_ranking(
+    CBossDamageRankingBossData* boss_data, const uint32_t player_id)
+{
+    auto* const player_data{boss_data->get_player_data()};
+
+    if (const auto max_participants{boss_data->get_policy().max_participants};
+        0U != max_participants && player_data->get_player_count() >= max_participants &&
+        !player_data->is_player_in_ranking(player_id))
+    {
+        return std::nullopt;
+    }
+
+    const auto profile_iter{m_profile_map.find(player_id)};
+    const auto& profile{
+        m_profile_map.end() == profile_iter ? BossDamageRankingPlayerProfile{} : profile_iter->second.profile};
+    const auto recipient_slot{
+        m_profile_map.end() == profile_iter ? no_recipient_slot : profile_iter->second.recipient_slot};
+
+    const auto [player_slot, inserted]{player_data->find_or_add_player(player_id, profile)};
+
+    if (!inserted) { return player_slot; }
+
+    // a known participant gets its new groups with PLAYER_ONLINE, in every fight at once
+    if (m_profile_map.end() != profile_iter) { player_data->set_groups(player_slot, profile_iter->second.group_profiles); }
+
+    m_participant_count.fetch_add(1U, std::memory_order_relaxed);
+
+    const auto& boss_info{*boss_data->get_boss_info()};
+
+    // the player's ranking version stays 0, so the next broadcast sends a full ranking again
+    BossDamageRankingDispatch dispatch{};
+    dispatch.full_packet = CBossDamageRankingManager::create_ranking_packet(boss_info.mob_vid,
+        boss_data->get_ranking_version(),
+        CBossDamageRankingManager::create_ranking_info_vector(*player_data, boss_info),
+        CBossDamageRankingManager::create_group_ranking_vector(*player_data, boss_info));
+    dispatch.recipient_vec.push_back({player_id,
+        recipient_slot,
+        0U,
+        CBossDamageRankingManager::create_damage_info(player_data->get_damage(player_slot),
+            boss_info,
+            player_data->get_player_rank(player_slot),
+            player_data->get_player_count(),
+            player_data->get_dps(player_slot, m_now))});
+    push_dispatch(std::move(dispatch));
+
+    return player_slot;
+}
+
+/**
+ * @brief Queue a boss for the next ranking broadcast
+ *
+ * @param boss_data The boss data object
+ * @param boss_handle The handle of the boss
+ */
+void CBossDamageRankingWorker::mark_boss_dirty(
+    CBossDamageRankingBossData* boss_data, const BossDamageRankingHandle& boss_handle)
+{
+    if (boss_data->mark_dirty()) { m_dirty_boss_vec.emplace_back(boss_handle); }
+}
+
+/**
+ * @brief Prepare the broadcasts of the dirty bosses whose broadcast interval elapsed
+ */
+void CBossDamageRankingWorker::flush_rankings()
+{
+    if (m_dirty_boss_vec.empty()) { return; }
+
+    const auto flush_pred_func{[this](const BossDamageRankingHandle& boss_handle)
+        {
+            auto* const boss_data{resolve_boss(boss_handle)};
+
+            if (nullptr == boss_data || !boss_data->is_dirty()) { return true; }
+
+            if (!boss_data->can_broadcast(m_now, boss_data->get_policy().broadcast_interval)) { return false; }
+
+            prepare_broadcast(boss_data);
+            boss_data->set_broadcasted(m_now);
+
+            return true;
+        }};
+
+#if __cplusplus >= 202002L
+    std::erase_if(m_dirty_boss_vec, flush_pred_func);
+#else
+    m_dirty_boss_vec.erase(
+        std::remove_if(m_dirty_boss_vec.begin(), m_dirty_boss_vec.end(), flush_pred_func), m_dirty_boss_vec.end());
+#endif
+}
+
+/**
+ * @brief Prepare the broadcast of a boss to its online participants
+ *
+ * @param boss_data The boss data object
+ *
+ * @details Starts a new ranking version, as CBossDamageRankingManager::create_ranking_container;
+ * a participant is online once the game thread sent its profile and until it logged out.
+ */
+void CBossDamageRankingWorker::prepare_broadcast(CBossDamageRankingBossData* boss_data)
+{
+    auto* const player_data{boss_data->get_player_data()};
+    const auto& boss_info{*boss_data->get_boss_info()};
+
+    const auto info_vec{CBossDamageRankingManager::create_ranking_info_vector(*player_data, boss_info)};
+    const auto group_ranking_vec{CBossDamageRankingManager::create_group_ranking_vector(*player_data, boss_info)};
+
+    BossDamageRankingDispatch dispatch{};
+    dispatch.is_broadcast = true;
+    dispatch.base_version = boss_data->get_ranking_version();
+    const auto version{boss_data->next_ranking_version()};
+
+    const auto row_mask_vec{
+        CBossDamageRankingManager::update_sent_rows(boss_data->get_sent_rows(), *player_data, info_vec)};
+    const auto changed_group_ranking_vec{
+        CBossDamageRankingManager::update_sent_group_rows(*boss_data, group_ranking_vec)};
+
+    dispatch.full_packet =
+        CBossDamageRankingManager::create_ranking_packet(boss_info.mob_vid, version, info_vec, group_ranking_vec);
+    dispatch.delta_packet = CBossDamageRankingManager::create_ranking_delta_packet(boss_info.mob_vid,
+        dispatch.base_version,
+        version,
+        info_vec,
+        row_mask_vec,
+        changed_group_ranking_vec);
+
+    const auto& player_id_vec{player_data->get_player_ids()};
+    const auto rank_vec{player_data->get_player_ranks()};
+    const auto participant_count{player_data->get_player_count()};
+
+    for (player_slot_t player_slot{}; player_slot < participant_count; ++player_slot)
+    {
+        const auto player_id{player_id_vec[player_slot]};
+        const auto profile_iter{m_profile_map.find(player_id)};
+
+        if (m_profile_map.end() == profile_iter) { continue; }
+
+        dispatch.recipient_vec.push_back({player_id,
+            profile_iter->second.recipient_slot,
+            player_data->get_ranking_version(player_slot),
+            CBossDamageRankingManager::create_damage_info(player_data->get_damage(player_slot),
+                boss_info,
+                rank_vec[player_slot],
+                participant_count,
+                player_data->get_dps(player_slot, m_now))});
+
+        player_data->set_ranking_version(player_slot, version);
+    }
+
+    push_dispatch(std::move(dispatch));
+}
+
+/**
+ * @brief Hand a dispatch to the game thread, keeping it aside while the ring is full
+ *
+ * @param dispatch The dispatch
+ *
+ * @details The worker never waits for the game thread.
+ */
+void CBossDamageRankingWorker::push_dispatch(BossDamageRankingDispatch dispatch)
+{
+    if (m_pending_dispatch_deque.empty() && m_dispatch_queue.try_push(dispatch)) { return; }
+
+    m_pending_dispatch_deque.emplace_back(std::move(dispatch));
+}
+
+/**
+ * @brief Move the dispatches kept aside into the ring, oldest first, as far as there is room
+ */
+void CBossDamageRankingWorker::flush_pending_dispatches()
+{
+    while (!m_pending_dispatch_deque.empty() && m_dispatch_queue.try_push(m_pending_dispatch_deque.front()))
+    {
+        m_pending_dispatch_deque.pop_front();
+    }
+}
+
+} // namespace bossdamageranking
+
+#endif // BOSS_DAMAGE_RANKING_PLUGIN
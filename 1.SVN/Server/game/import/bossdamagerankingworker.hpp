@@ -0,0 +1,416 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef BOSSDAMAGERANKINGWORKER_HPP
+#define BOSSDAMAGERANKINGWORKER_HPP
+
+#include <deque>
+#include <thread>
+
+#include "bossdamageranking.hpp"
+#include "networkutils.hpp"
+#include "packet.h"
+#include "spscqueue.hpp"
+
+namespace bossdamageranking
+{
+
+/**
+ * @brief Kind of an event sent from the game thread to the ranking worker
+ */
+enum class EBossDamageRankingEventType : uint8_t
+{
+    ADD_BOSS,
+    ERASE_BOSS,
+    PLAYER_ONLINE,
+    PLAYER_OFFLINE,
+    DAMAGE,
+    BAD_AFFECT,
+    PULSE,
+};
+
+/**
+ * @brief Event sent from the game thread to the ranking worker, 40 bytes
+ */
+struct BossDamageRankingEvent
+{
+    EBossDamageRankingEventType type{};
+
+    /**
+     * @brief BadAffectType of BAD_AFFECT, EBossDamageRankingFightEnd of ERASE_BOSS
+     */
+    uint8_t flags{};
+
+    uint32_t player_id{};
+
+    /**
+     * @brief Game time the event was queued at, stamped by push_event
+     */
+    uint32_t time{};
+
+    BossDamageRankingHandle boss_handle{};
+
+    /**
+     * @brief Damage of DAMAGE
+     */
+    uint64_t amount{};
+
+    /**
+     * @brief Boss record of ADD_BOSS, owned by the game thread
+     */
+    CBossDamageRankingBossData* p_boss_data{};
+};
+
+/**
+ * @brief Profile of an online player sent with PLAYER_ONLINE
+ */
+struct BossDamageRankingOnlineProfile
+{
+    /**
+     * @brief The name and race shown in the rankings
+     */
+    BossDamageRankingPlayerProfile profile{};
+
+    /**
+     * @brief The party and guild the player's hits are added to
+     */
+    boss_damage_ranking_group_profiles_t group_profiles{};
+
+    /**
+     * @brief Slot of the character in the game thread's recipient table
+     */
+    uint32_t recipient_slot{no_recipient_slot};
+};
+
+/**
+ * @brief Recipient of a prepared ranking packet and its personal damage row
+ */
+struct BossDamageRankingDispatchRecipient
+{
+    uint32_t player_id{};
+
+    /**
+     * @brief Slot of the character in the game thread's recipient table, checked against the player ID
+     */
+    uint32_t recipient_slot{};
+
+    uint32_t ranking_version{};
+    SPacketGCBossDamageRankingDamageInfo damage_info{};
+};
+
+/**
+ * @brief Work handed back from the ranking worker to the game thread
+ *
+ * @details Either a ranking ready to be sent, or a retired boss record: the worker
+ * no longer touches it, so the game thread may persist and free it.
+ */
+struct BossDamageRankingDispatch
+{
+    networkutils::shared_packet_t full_packet{};
+    networkutils::shared_packet_t delta_packet{};
+
+    /**
+     * @brief Ranking version the delta applies to, 0 if only the full packet is valid
+     */
+    uint32_t base_version{};
+
+    /**
+     * @brief False for the ranking sent to a player that just joined
+     */
+    bool is_broadcast{};
+
+    std::vector<BossDamageRankingDispatchRecipient> recipient_vec{};
+
+    /**
+     * @brief Boss record given back after ERASE_BOSS, nullptr for a ranking
+     */
+    CBossDamageRankingBossData* p_retired_boss{};
+};
+
+/**
+ * @brief Thread that owns the ranking state of the tracked bosses
+ *
+ * @details The game thread keeps the registry (slots, generations, VID index, config)
+ * and pushes compact events into a lock-free ring; the worker applies them in order,
+ * so every boss sees its hits in game order. Neither side waits for the other: a hit
+ * that finds the ring full comes back later, folded with the other dropped hits of
+ * the same player on the same boss. The worker keeps the top rankings,
+ * throttles the broadcasts and serializes the packets, which come back through a
+ * second ring that the game thread drains to the clients. Characters, descriptors and
+ * libthecore are never touched here: participants are known by player ID and profile
+ * only, time comes with the events and packets are built in plain byte buffers.
+ */
+class CBossDamageRankingWorker
+{
+public:
+    /**
+     * @brief Slots of the event ring, 2.5 MiB
+     */
+    static constexpr size_t event_queue_capacity{1U << 16};
+
+    /**
+     * @brief Slots of the dispatch ring
+     */
+    static constexpr size_t dispatch_queue_capacity{1U << 12};
+
+    /**
+     * @brief Slots of the profile ring, one profile per PLAYER_ONLINE event
+     */
+    static constexpr size_t profile_queue_capacity{1U << 12};
+
+    /**
+     * @brief Construct a new CBossDamageRankingWorker object and start its thread
+     */
+    CBossDamageRankingWorker();
+
+    CBossDamageRankingWorker(const CBossDamageRankingWorker&) = delete;
+    CBossDamageRankingWorker& operator=(const CBossDamageRankingWorker&) = delete;
+
+    /**
+     * @brief Destroy the CBossDamageRankingWorker object, joining its thread
+     */
+    ~CBossDamageRankingWorker();
+
+    /**
+     * @brief Queue an event, game thread only
+     *
+     * @param event The event
+     *
+     * @details Never waits for the worker. While the ring is full, a boss or player
+     * event or a PULSE is kept aside in order, and a hit is dropped with its damage
+     * folded into one resent hit per boss and player.
+     */
+    void push_event(const BossDamageRankingEvent& event);
+
+    /**
+     * @brief Queue a PLAYER_ONLINE event with the profile shown in the rankings, game thread only
+     *
+     * @param player_id The player ID
+     * @param online_profile The name, race, party and guild of the player
+     *
+     * @details Queued again when the player joins or leaves a party or guild; the
+     * newer profile replaces the older one.
+     */
+    void push_player_online(uint32_t player_id, const BossDamageRankingOnlineProfile& online_profile);
+
+    /**
+     * @brief Move the events kept aside and the folded damage into the rings, game thread only
+     *
+     * @return bool True once nothing is left aside
+     */
+    bool flush_pending_events();
+
+    /**
+     * @brief Take the oldest prepared dispatch, game thread only
+     *
+     * @param dispatch Receives the dispatch
+     * @return bool False if none is ready
+     */
+    [[nodiscard]] bool pop_dispatch(BossDamageRankingDispatch& dispatch);
+
+    /**
+     * @brief Ask the thread to stop once every queued event is applied
+     */
+    void request_stop() noexcept;
+
+    /**
+     * @brief Check if the thread is still applying events
+     *
+     * @return bool False once it stopped after request_stop
+     */
+    [[nodiscard]] bool is_running() const noexcept;
+
+    /**
+     * @brief Get the number of events the game thread moved into the ring
+     */
+    [[nodiscard]] uint64_t get_event_count() const noexcept;
+
+    /**
+     * @brief Get the number of events the worker applied, any thread
+     */
+    [[nodiscard]] uint64_t get_applied_event_count() const noexcept;
+
+    /**
+     * @brief Get the number of hits the game thread dropped on a full ring, their damage is resent
+     */
+    [[nodiscard]] uint64_t get_dropped_event_count() const noexcept;
+
+    /**
+     * @brief Get the number of events kept aside and folded hits waiting for room in the ring
+     */
+    [[nodiscard]] size_t get_pending_event_count() const noexcept;
+
+    /**
+     * @brief Get the number of participants of the bosses held by the worker
+     */
+    [[nodiscard]] size_t get_participant_count() const noexcept;
+
+private:
+    /**
+     * @brief Event kept aside by the game thread while the ring is full, with the profile of PLAYER_ONLINE
+     */
+    struct PendingEvent
+    {
+        BossDamageRankingEvent event{};
+        BossDamageRankingOnlineProfile online_profile{};
+
+        /**
+         * @brief True once the profile is in the profile ring and only the event is left
+         */
+        bool is_profile_published{};
+    };
+
+    /**
+     * @brief Boss record held by the worker and the generation of the handle it was added with
+     */
+    struct WorkerBoss
+    {
+        CBossDamageRankingBossData* p_boss_data{};
+        uint32_t generation{};
+    };
+
+    /**
+     * @brief Move an event into the ring, publishing the profile of PLAYER_ONLINE first, game thread only
+     *
+     * @param pending The event, left as is if the ring is full
+     * @return bool False if the ring is full
+     */
+    [[nodiscard]] bool try_queue_event(PendingEvent& pending);
+
+    /**
+     * @brief Queue a boss, player or PULSE event, keeping it aside behind the older ones while the ring is full
+     *
+     * @param pending The event
+     */
+    void queue_control_event(PendingEvent pending);
+
+    /**
+     * @brief Queue the folded damage that must be applied before a boss is erased or a player goes offline
+     *
+     * @param event The ERASE_BOSS or PLAYER_OFFLINE event about to be queued
+     */
+    void queue_lost_damage(const BossDamageRankingEvent& event);
+
+    /**
+     * @brief Body of the worker thread
+     */
+    void run();
+
+    /**
+     * @brief Apply one event
+     *
+     * @param event The event
+     */
+    void process_event(const BossDamageRankingEvent& event);
+
+    /**
+     * @brief Resolve a boss handle to a boss held by the worker
+     *
+     * @param boss_handle The handle
+     * @return CBossDamageRankingBossData* The boss data, or nullptr if the boss was erased
+     */
+    [[nodiscard]] CBossDamageRankingBossData* resolve_boss(const BossDamageRankingHandle& boss_handle) const noexcept;
+
+    /**
+     * @brief Find the participant slot of a player, adding it and preparing its first ranking if needed
+     *
+     * @param boss_data The boss data object
+     * @param player_id The player ID
+     * @return std::optional<player_slot_t> The participant slot, or std::nullopt if the fight is full
+     */
+    std::optional<player_slot_t> ensure_player_in_ranking(CBossDamageRankingBossData* boss_data, uint32_t player_id);
+
+    /**
+     * @brief Queue a boss for the next ranking broadcast
+     *
+     * @param boss_data The boss data object
+     * @param boss_handle The handle of the boss
+     */
+    void mark_boss_dirty(CBossDamageRankingBossData* boss_data, const BossDamageRankingHandle& boss_handle);
+
+    /**
+     * @brief Prepare the broadcasts of the dirty bosses whose broadcast interval elapsed, on each PULSE
+     */
+    void flush_rankings();
+
+    /**
+     * @brief Prepare the broadcast of a boss to its online participants
+     *
+     * @param boss_data The boss data object
+     */
+    void prepare_broadcast(CBossDamageRankingBossData* boss_data);
+
+    /**
+     * @brief Hand a dispatch to the game thread, keeping it aside while the ring is full
+     *
+     * @param dispatch The dispatch
+     *
+     * @details The worker never waits for the game thread.
+     */
+    void push_dispatch(BossDamageRankingDispatch dispatch);
+
+    /**
+     * @brief Move the dispatches kept aside into the ring, oldest first, as far as there is room
+     */
+    void flush_pending_dispatches();
+
+    threadutils::SpscQueue<BossDamageRankingEvent> m_event_queue{event_queue_capacity};
+    threadutils::SpscQueue<BossDamageRankingOnlineProfile> m_profile_queue{profile_queue_capacity};
+    threadutils::SpscQueue<BossDamageRankingDispatch> m_dispatch_queue{dispatch_queue_capacity};
+
+    /**
+     * @brief Game thread counters
+     */
+    uint64_t m_event_count{};
+    uint64_t m_dropped_event_count{};
+
+    /**
+     * @brief Boss and player events that did not fit in the ring yet, in order, game thread only
+     */
+    std::deque<PendingEvent> m_pending_event_deque{};
+
+    /**
+     * @brief Damage of the dropped hits by boss slot and player ID, resent once there is room, game thread only
+     */
+    std::unordered_map<uint64_t, BossDamageRankingEvent> m_lost_damage_map{};
+
+    std::atomic<uint64_t> m_applied_event_count{};
+    std::atomic<bool> m_stop_requested{};
+    std::atomic<bool> m_running{true};
+    std::atomic<size_t> m_participant_count{};
+
+    /**
+     * @brief Game time of the last applied event, the worker never reads the clock itself
+     */
+    uint32_t m_now{};
+
+    /**
+     * @brief Bosses held by the worker, indexed by boss slot
+     */
+    std::vector<WorkerBoss> m_boss_vec{};
+
+    /**
+     * @brief Profiles of the online players that hit a ranked boss, by player ID
+     */
+    std::unordered_map<uint32_t, BossDamageRankingOnlineProfile> m_profile_map{};
+
+    /**
+     * @brief Bosses whose ranking changed since their last broadcast
+     */
+    std::vector<BossDamageRankingHandle> m_dirty_boss_vec{};
+
+    /**
+     * @brief Dispatches that did not fit in the ring yet, in order
+     */
+    std::deque<BossDamageRankingDispatch> m_pending_dispatch_deque{};
+
+    /**
+     * @brief Started last, once every member it uses exists
+     */
+    std::thread m_thread{};
+};
+
+} // namespace bossdamageranking
+
+#endif // BOSSDAMAGERANKINGWORKER_HPP
@@ -0,0 +1,312 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef FLATINDEX_HPP
+#define FLATINDEX_HPP
+
+#include <memory_resource>
+
+namespace hashutils
+{
+
+/**
+ * @brief Open-addressing index mapping an integral key to a 32-bit slot
+ *
+ * @details Buckets live in one contiguous array (power-of-two capacity,
+ * linear probing, Fibonacci hashing), so a lookup is one multiply and a short
+ * probe over adjacent memory. The index only stores slot numbers; the records
+ * themselves stay in whatever contiguous storage the owner uses. The buckets
+ * come from the given memory resource, so an index can live in its owner's arena.
+ */
+template <typename Key = uint32_t>
+class FlatIndex
+{
+public:
+    /**
+     * @brief Construct an empty index
+     *
+     * @param resource The memory resource providing the buckets
+     */
+    explicit FlatIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+        : m_buckets{resource}
+    {
+    }
+
+    /**
+     * @brief Slot type stored for each key
+     */
+    using slot_t = uint32_t;
+
+    /**
+     * @brief Returned by find() when the key is not indexed
+     */
+    static constexpr slot_t npos{std::numeric_limits<slot_t>::max()};
+
+    /**
+     * @brief Look up the slot stored for a key
+     *
+     * @param key The key to look up
+     * @return slot_t The slot, or npos if the key is not indexed
+     */
+    [[nodiscard]] slot_t find(const Key key) const noexcept
+    {
+        if (m_buckets.empty())
+        {
+            return npos;
+        }
+
+        for (auto index{bucket_of(key)};; index = (index + 1) & mask())
+        {
+            const auto& bucket{m_buckets[index]};
+
+            if (empty_slot == bucket.slot)
+            {
+                return npos;
+            }
+
+            if (tombstone_slot != bucket.slot && bucket.key == key)
+            {
+                return bucket.slot;
+            }
+        }
+    }
+
+    /**
+     * @brief Look up a key and insert it with the given slot if it is missing
+     *
+     * @param key The key to look up
+     * @param slot The slot to store when the key is not indexed yet
+     * @return std::pair<slot_t, bool> The stored slot and whether it was inserted
+     */
+    std::pair<slot_t, bool> find_or_insert(const Key key, const slot_t slot)
+    {
+        if ((m_used + 1) * 2 > m_buckets.size())
+        {
+            rehash(m_buckets.empty() ? min_capacity : m_buckets.size() * (m_size * 4 > m_buckets.size() ? 2 : 1));
+        }
+
+        auto reuse_index{npos};
+
+        for (auto index{bucket_of(key)};; index = (index + 1) & mask())
+        {
+            auto& bucket{m_buckets[index]};
+
+            if (empty_slot == bucket.slot)
+            {
+                if (npos == reuse_index)
+                {
+                    reuse_index = index;
+                    ++m_used;
+                }
+
+                break;
+            }
+
+            if (tombstone_slot == bucket.slot)
+            {
+                if (npos == reuse_index)
+                {
+                    reuse_index = index;
+                }
+
+                continue;
+            }
+
+            if (bucket.key == key)
+            {
+                return {bucket.slot, false};
+            }
+        }
+
+        m_buckets[reuse_index] = {key, slot};
+        ++m_size;
+
+        return {slot, true};
+    }
+
+    /**
+     * @brief Change the slot stored for an indexed key
+     *
+     * @param key The key to update
+     * @param slot The new slot
+     * @return bool True if the key was found
+     */
+    bool update(const Key key, const slot_t slot) noexcept
+    {
+        auto* const bucket{find_bucket(key)};
+
+        if (nullptr == bucket)
+        {
+            return false;
+        }
+
+        bucket->slot = slot;
+
+        return true;
+    }
+
+    /**
+     * @brief Remove a key from the index
+     *
+     * @param key The key to remove
+     * @return bool True if the key was found
+     */
+    bool erase(const Key key) noexcept
+    {
+        auto* const bucket{find_bucket(key)};
+
+        if (nullptr == bucket)
+        {
+            return false;
+        }
+
+        bucket->slot = tombstone_slot;
+        --m_size;
+
+        return true;
+    }
+
+    /**
+     * @brief Pre-size the index for an expected number of keys
+     *
+     * @param count The expected number of keys
+     */
+    void reserve(const size_t count)
+    {
+        auto capacity{min_capacity};
+
+        while (capacity < count * 2)
+        {
+            capacity *= 2;
+        }
+
+        if (capacity > m_buckets.size())
+        {
+            rehash(capacity);
+        }
+    }
+
+    /**
+     * @brief Remove every key, keeping the allocated buckets
+     */
+    void clear() noexcept
+    {
+        std::fill(m_buckets.begin(), m_buckets.end(), Bucket{});
+        m_size = 0;
+        m_used = 0;
+    }
+
+    /**
+     * @brief Number of indexed keys
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+private:
+    /**
+     * @brief Bucket states encoded in the slot field
+     */
+    static constexpr slot_t empty_slot{npos};
+    static constexpr slot_t tombstone_slot{npos - 1};
+
+    /**
+     * @brief Smallest bucket count allocated on first insert
+     */
+    static constexpr size_t min_capacity{16U};
+
+    struct Bucket
+    {
+        Key key{};
+        slot_t slot{empty_slot};
+    };
+
+    [[nodiscard]] size_t mask() const noexcept
+    {
+        return m_buckets.size() - 1;
+    }
+
+    [[nodiscard]] size_t bucket_of(const Key key) const noexcept
+    {
+        static constexpr uint64_t fibonacci_multiplier{11400714819323198485ULL};
+
+        return static_cast<size_t>((static_cast<uint64_t>(key) * fibonacci_multiplier) >> m_shift);
+    }
+
+    [[nodiscard]] Bucket* find_bucket(const Key key) noexcept
+    {
+        if (m_buckets.empty())
+        {
+            return nullptr;
+        }
+
+        for (auto index{bucket_of(key)};; index = (index + 1) & mask())
+        {
+            auto& bucket{m_buckets[index]};
+
+            if (empty_slot == bucket.slot)
+            {
+                return nullptr;
+            }
+
+            if (tombstone_slot != bucket.slot && bucket.key == key)
+            {
+                return &bucket;
+            }
+        }
+    }
+
+    /**
+     * @brief Rebuild the buckets with a new capacity, dropping tombstones
+     *
+     * @param capacity The new bucket count, a power of two
+     */
+    void rehash(const size_t capacity)
+    {
+        std::pmr::vector<Bucket> old_buckets(capacity, m_buckets.get_allocator());
+        old_buckets.swap(m_buckets);
+
+        m_shift = 64U;
+        for (auto bits{capacity}; bits > 1; bits >>= 1)
+        {
+            --m_shift;
+        }
+
+        m_size = 0;
+        m_used = 0;
+
+        for (const auto& bucket : old_buckets)
+        {
+            if (empty_slot != bucket.slot && tombstone_slot != bucket.slot)
+            {
+                find_or_insert(bucket.key, bucket.slot);
+            }
+        }
+    }
+
+    /**
+     * @brief Bucket array
+     */
+    std::pmr::vector<Bucket> m_buckets{};
+
+    /**
+     * @brief Live keys
+     */
+    size_t m_size{};
+
+    /**
+     * @brief Live keys plus tombstones, drives the load factor
+     */
+    size_t m_used{};
+
+    /**
+     * @brief Right shift turning the hashed key into a bucket index
+     */
+    uint8_t m_shift{64U};
+};
+
+} // namespace hashutils
+
+#endif // FLATINDEX_HPP
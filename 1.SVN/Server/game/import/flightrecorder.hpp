@@ -0,0 +1,243 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef FLIGHTRECORDER_HPP
+#define FLIGHTRECORDER_HPP
+
+#include <chrono>
+#include <cstdio>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace perfutils
+{
+
+/**
+ * @brief Read the cheapest monotonic tick counter of the platform
+ *
+ * @return uint64_t The time stamp counter, or steady_clock nanoseconds where there is none
+ */
+[[nodiscard]] inline uint64_t read_ticks() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief One finished span of the flight recorder
+ */
+struct TraceEvent
+{
+    /**
+     * @brief Span name, a string literal
+     */
+    const char* p_name{};
+    uint64_t start_ticks{};
+    uint64_t end_ticks{};
+    uint32_t boss_vid{};
+    uint32_t participant_count{};
+};
+
+/**
+ * @brief In-memory ring of the latest spans, dumped as a Chrome/Perfetto trace
+ *
+ * @details Off by default. While off a span costs the check of the enabled flag
+ * and nothing else; while on it costs two tick reads and one 32-byte store into
+ * a ring allocated when recording starts. The oldest spans are overwritten.
+ */
+class FlightRecorder
+{
+public:
+    /**
+     * @brief Ring size used when none is given, 2 MiB of events
+     */
+    static constexpr size_t default_capacity{1U << 16};
+
+    FlightRecorder() = default;
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * @brief Check if spans are recorded
+     */
+    [[nodiscard]] bool is_enabled() const noexcept
+    {
+        return m_enabled;
+    }
+
+    /**
+     * @brief Start recording into a new ring, dropping the spans recorded so far
+     *
+     * @param capacity The number of spans kept, rounded up to a power of two
+     */
+    void start(const size_t capacity = default_capacity)
+    {
+        size_t ring_size{1U};
+
+        while (ring_size < capacity)
+        {
+            ring_size <<= 1U;
+        }
+
+        m_event_vec.assign(ring_size, TraceEvent{});
+        m_recorded_count = 0U;
+        m_start_ticks = read_ticks();
+        m_start_time = std::chrono::steady_clock::now();
+        m_enabled = true;
+    }
+
+    /**
+     * @brief Stop recording, the ring is kept for a dump
+     */
+    void stop() noexcept
+    {
+        m_enabled = false;
+    }
+
+    /**
+     * @brief Record a finished span
+     *
+     * @param event The span
+     */
+    void record(const TraceEvent& event) noexcept
+    {
+        m_event_vec[m_recorded_count & (m_event_vec.size() - 1U)] = event;
+        ++m_recorded_count;
+    }
+
+    /**
+     * @brief Get the number of spans held by the ring
+     */
+    [[nodiscard]] size_t get_event_count() const noexcept
+    {
+        return static_cast<size_t>(std::min<uint64_t>(m_recorded_count, m_event_vec.size()));
+    }
+
+    /**
+     * @brief Write the ring as a Chrome trace event file, oldest span first
+     *
+     * @param p_path The file to write
+     * @return bool False if the file could not be written or nothing was recorded
+     *
+     * @details Ticks are turned into microseconds with the tick rate measured between
+     * start() and this call, so the file can be opened in chrome://tracing or Perfetto.
+     */
+    [[nodiscard]] bool dump_chrome_trace(const char* p_path) const
+    {
+        if (m_event_vec.empty())
+        {
+            return false;
+        }
+
+        auto* const p_file{std::fopen(p_path, "w")};
+
+        if (nullptr == p_file)
+        {
+            return false;
+        }
+
+        const auto elapsed_us{
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_start_time).count()};
+        const auto elapsed_ticks{static_cast<double>(read_ticks() - m_start_ticks)};
+        const auto us_per_tick{elapsed_ticks > 0.0 ? elapsed_us / elapsed_ticks : 0.0};
+
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", p_file);
+
+        const auto event_count{get_event_count()};
+        const auto first_index{m_recorded_count - event_count};
+
+        for (size_t index{}; index < event_count; ++index)
+        {
+            const auto& event{m_event_vec[(first_index + index) & (m_event_vec.size() - 1U)]};
+
+            std::fprintf(p_file,
+                "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                "\"args\":{\"boss_vid\":%u,\"participants\":%u}}",
+                0U == index ? "" : ",",
+                event.p_name,
+                static_cast<double>(event.start_ticks - m_start_ticks) * us_per_tick,
+                static_cast<double>(event.end_ticks - event.start_ticks) * us_per_tick,
+                event.boss_vid,
+                event.participant_count);
+        }
+
+        std::fputs("\n]}\n", p_file);
+
+        return 0 == std::fclose(p_file);
+    }
+
+private:
+    bool m_enabled{};
+    std::vector<TraceEvent> m_event_vec{};
+    uint64_t m_recorded_count{};
+    uint64_t m_start_ticks{};
+    std::chrono::steady_clock::time_point m_start_time{};
+};
+
+/**
+ * @brief Scope recorded as one span while the recorder is enabled
+ */
+class TraceSpan
+{
+public:
+    /**
+     * @brief Construct a new TraceSpan object
+     *
+     * @param recorder The flight recorder
+     * @param p_name The span name, a string literal
+     * @param boss_vid The VID of the boss the span works on, if already known
+     * @param participant_count The participants of the boss, if already known
+     */
+    TraceSpan(FlightRecorder& recorder, const char* p_name, const uint32_t boss_vid = 0U,
+              const uint32_t participant_count = 0U) noexcept
+    {
+        if (recorder.is_enabled()) [[unlikely]]
+        {
+            mp_recorder = &recorder;
+            m_event.p_name = p_name;
+            m_event.boss_vid = boss_vid;
+            m_event.participant_count = participant_count;
+            m_event.start_ticks = read_ticks();
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    ~TraceSpan()
+    {
+        if (nullptr != mp_recorder) [[unlikely]]
+        {
+            m_event.end_ticks = read_ticks();
+            mp_recorder->record(m_event);
+        }
+    }
+
+    /**
+     * @brief Tag the span with the boss it worked on, once known
+     *
+     * @param boss_vid The VID of the boss
+     * @param participant_count The participants of the boss
+     */
+    void set_boss(const uint32_t boss_vid, const size_t participant_count) noexcept
+    {
+        if (nullptr != mp_recorder) [[unlikely]]
+        {
+            m_event.boss_vid = boss_vid;
+            m_event.participant_count = static_cast<uint32_t>(participant_count);
+        }
+    }
+
+private:
+    FlightRecorder* mp_recorder{};
+    TraceEvent m_event{};
+};
+
+} // namespace perfutils
+
+#endif // FLIGHTRECORDER_HPP
@@ -0,0 +1,187 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef LATENCYSTATS_HPP
+#define LATENCYSTATS_HPP
+
+#include <chrono>
+#if __cplusplus >= 202002L
+#include <bit>
+#endif
+
+namespace perfutils
+{
+
+/**
+ * @brief Histogram of latencies in power-of-two nanosecond buckets
+ *
+ * @details Bucket i holds the latencies whose bit width is i, i.e. [2^(i-1), 2^i),
+ * so recording is a bit scan and an increment and the whole histogram fits in a
+ * few cache lines.
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @brief Number of buckets, the last one also holds everything above 2^38 ns
+     */
+    static constexpr size_t bucket_count{40U};
+
+    /**
+     * @brief Record one latency
+     *
+     * @param latency_ns The latency in nanoseconds
+     */
+    void record(const uint64_t latency_ns) noexcept
+    {
+        ++m_buckets[std::min(bit_width(latency_ns), bucket_count - 1U)];
+        ++m_count;
+        m_total_ns += latency_ns;
+        m_max_ns = std::max(m_max_ns, latency_ns);
+    }
+
+    /**
+     * @brief Get the number of recorded latencies
+     */
+    [[nodiscard]] uint64_t get_count() const noexcept
+    {
+        return m_count;
+    }
+
+    /**
+     * @brief Get the mean latency in nanoseconds, 0 if nothing was recorded
+     */
+    [[nodiscard]] uint64_t get_mean_ns() const noexcept
+    {
+        return 0U == m_count ? 0U : m_total_ns / m_count;
+    }
+
+    /**
+     * @brief Get the highest recorded latency in nanoseconds
+     */
+    [[nodiscard]] uint64_t get_max_ns() const noexcept
+    {
+        return m_max_ns;
+    }
+
+    /**
+     * @brief Get an upper bound of a latency percentile
+     *
+     * @param percentile The percentile, 0 to 100
+     * @return uint64_t The upper bound of the bucket holding the percentile, in nanoseconds
+     */
+    [[nodiscard]] uint64_t get_percentile_ns(const uint32_t percentile) const noexcept
+    {
+        if (0U == m_count)
+        {
+            return 0U;
+        }
+
+        const auto rank{std::max<uint64_t>((m_count * std::min(percentile, 100U) + 99U) / 100U, 1U)};
+        uint64_t seen{};
+
+        for (size_t bucket{}; bucket < bucket_count; ++bucket)
+        {
+            seen += m_buckets[bucket];
+
+            if (seen >= rank)
+            {
+                return std::min(0U == bucket ? 0U : (uint64_t{1} << bucket) - 1U, m_max_ns);
+            }
+        }
+
+        return m_max_ns;
+    }
+
+private:
+    [[nodiscard]] static size_t bit_width(const uint64_t value) noexcept
+    {
+#if __cplusplus >= 202002L
+        return static_cast<size_t>(std::bit_width(value));
+#else
+        size_t width{};
+
+        for (auto rest{value}; 0U != rest; rest >>= 1U)
+        {
+            ++width;
+        }
+
+        return width;
+#endif
+    }
+
+    std::array<uint64_t, bucket_count> m_buckets{};
+    uint64_t m_count{};
+    uint64_t m_total_ns{};
+    uint64_t m_max_ns{};
+};
+
+/**
+ * @brief Call counter of a function and a histogram of a sample of its latencies
+ */
+struct CallStats
+{
+    /**
+     * @brief Every call
+     */
+    uint64_t calls{};
+
+    /**
+     * @brief Latencies of the sampled calls
+     */
+    LatencyHistogram latency{};
+};
+
+/**
+ * @brief Scope counting a call and timing one call in sample_interval
+ *
+ * @details Reading the clock costs about as much as a whole hit, so only the
+ * sampled calls pay for it; the others cost an increment and a branch.
+ */
+class SampledCallTimer
+{
+public:
+    /**
+     * @brief Sample interval of the calls made on every hit
+     */
+    static constexpr uint64_t default_sample_interval{64U};
+
+    /**
+     * @brief Construct a new SampledCallTimer object
+     *
+     * @param stats The counters of the timed function
+     * @param sample_interval One call in sample_interval is timed, a power of two
+     */
+    explicit SampledCallTimer(CallStats& stats, const uint64_t sample_interval = default_sample_interval) noexcept
+        : m_stats{stats}
+    {
+        if (0U == (m_stats.calls++ & (sample_interval - 1U)))
+        {
+            m_start_time = std::chrono::steady_clock::now();
+            m_sampled = true;
+        }
+    }
+
+    SampledCallTimer(const SampledCallTimer&) = delete;
+    SampledCallTimer& operator=(const SampledCallTimer&) = delete;
+
+    ~SampledCallTimer()
+    {
+        if (m_sampled)
+        {
+            const auto elapsed{std::chrono::steady_clock::now() - m_start_time};
+            m_stats.latency.record(
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+private:
+    CallStats& m_stats;
+    std::chrono::steady_clock::time_point m_start_time{};
+    bool m_sampled{};
+};
+
+} // namespace perfutils
+
+#endif // LATENCYSTATS_HPP
@@ -0,0 +1,210 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef MEMORYPOOL_HPP
+#define MEMORYPOOL_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace memutils
+{
+
+/**
+ * @brief Allocation counters of a memory resource or pool
+ */
+struct AllocationStats
+{
+    uint64_t allocations{};
+    uint64_t deallocations{};
+    uint64_t bytes_allocated{};
+    uint64_t bytes_in_use{};
+    uint64_t peak_bytes_in_use{};
+};
+
+/**
+ * @brief Memory resource forwarding to an upstream resource and counting what goes through it
+ *
+ * @details Used as the upstream of the per-fight arenas, so it only sees the
+ * few large blocks the arenas request, never the individual records.
+ */
+class CountingResource final : public std::pmr::memory_resource
+{
+public:
+    /**
+     * @brief Construct a new CountingResource object
+     *
+     * @param upstream The resource that actually provides the memory
+     */
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept
+        : mp_upstream{upstream}
+    {
+    }
+
+    /**
+     * @brief Get the allocation counters
+     */
+    [[nodiscard]] const AllocationStats& get_stats() const noexcept
+    {
+        return m_stats;
+    }
+
+private:
+    void* do_allocate(const size_t bytes, const size_t alignment) override
+    {
+        auto* const p_memory{mp_upstream->allocate(bytes, alignment)};
+
+        ++m_stats.allocations;
+        m_stats.bytes_allocated += bytes;
+        m_stats.bytes_in_use += bytes;
+        m_stats.peak_bytes_in_use = std::max(m_stats.peak_bytes_in_use, m_stats.bytes_in_use);
+
+        return p_memory;
+    }
+
+    void do_deallocate(void* p_memory, const size_t bytes, const size_t alignment) override
+    {
+        mp_upstream->deallocate(p_memory, bytes, alignment);
+
+        ++m_stats.deallocations;
+        m_stats.bytes_in_use -= bytes;
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    /**
+     * @brief Resource that actually provides the memory
+     */
+    std::pmr::memory_resource* mp_upstream{};
+
+    /**
+     * @brief Allocation counters
+     */
+    AllocationStats m_stats{};
+};
+
+/**
+ * @brief Fixed-size slab pool of objects of one type
+ *
+ * @details Objects are carved out of chunks of ChunkSize slots; a destroyed
+ * object's slot goes back to a free list and is reused by the next create(),
+ * so a steady number of live objects causes no allocation at all. The pool
+ * must outlive every pointer it handed out.
+ */
+template <typename T, size_t ChunkSize = 32U>
+class ObjectPool
+{
+public:
+    /**
+     * @brief Deleter returning an object to its pool
+     */
+    struct Deleter
+    {
+        ObjectPool* p_pool{};
+
+        void operator()(T* p_object) const noexcept
+        {
+            p_pool->destroy(p_object);
+        }
+    };
+
+    /**
+     * @brief Owning pointer to a pooled object
+     */
+    using ptr_t = std::unique_ptr<T, Deleter>;
+
+    ObjectPool() noexcept = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /**
+     * @brief Construct an object in a free slot
+     *
+     * @param args The constructor arguments
+     * @return ptr_t The object, returned to the pool when the pointer is reset
+     */
+    template <typename... Args>
+    ptr_t create(Args&&... args)
+    {
+        if (m_free_slot_vec.empty())
+        {
+            grow();
+        }
+
+        auto* const p_slot{m_free_slot_vec.back()};
+        auto* const p_object{::new (static_cast<void*>(p_slot)) T(std::forward<Args>(args)...)};
+        m_free_slot_vec.pop_back();
+
+        ++m_stats.allocations;
+        m_stats.bytes_in_use += sizeof(T);
+        m_stats.peak_bytes_in_use = std::max(m_stats.peak_bytes_in_use, m_stats.bytes_in_use);
+
+        return ptr_t{p_object, Deleter{this}};
+    }
+
+    /**
+     * @brief Get the object counters
+     *
+     * @details bytes_allocated counts the chunk memory taken from the heap,
+     * bytes_in_use the memory of the live objects.
+     */
+    [[nodiscard]] const AllocationStats& get_stats() const noexcept
+    {
+        return m_stats;
+    }
+
+private:
+    struct alignas(T) Slot
+    {
+        std::byte storage[sizeof(T)];
+    };
+
+    void destroy(T* p_object) noexcept
+    {
+        p_object->~T();
+
+        // grow() reserved room for every slot, so this never reallocates
+        m_free_slot_vec.push_back(reinterpret_cast<Slot*>(p_object));
+
+        ++m_stats.deallocations;
+        m_stats.bytes_in_use -= sizeof(T);
+    }
+
+    void grow()
+    {
+        auto& chunk{m_chunk_vec.emplace_back(std::make_unique<Slot[]>(ChunkSize))};
+
+        m_free_slot_vec.reserve(m_chunk_vec.size() * ChunkSize);
+
+        // hand out the lowest addresses first
+        for (auto index{ChunkSize}; index > 0U; --index)
+        {
+            m_free_slot_vec.push_back(&chunk[index - 1U]);
+        }
+
+        m_stats.bytes_allocated += sizeof(Slot) * ChunkSize;
+    }
+
+    /**
+     * @brief Slot chunks, never released before the pool
+     */
+    std::vector<std::unique_ptr<Slot[]>> m_chunk_vec{};
+
+    /**
+     * @brief Free slots, the next one to use last
+     */
+    std::vector<Slot*> m_free_slot_vec{};
+
+    /**
+     * @brief Object counters
+     */
+    AllocationStats m_stats{};
+};
+
+} // namespace memutils
+
+#endif // MEMORYPOOL_HPP
@@ -12,6 +12,64 @@
 
 namespace networkutils
 {
+/**
+ * @brief Immutable serialized packet, shared by every recipient of a broadcast
+ */
+using shared_packet_t = std::shared_ptr<const std::vector<uint8_t>>;
+
+#pragma pack(push, 1)
+/**
+ * @brief Small fixed-size packet appended after a shared packet
+ */
+template <typename Payload, typename HeaderPacket = DynamicPacketInfo>
+struct DynamicPacket
+{
+    HeaderPacket header_packet;
+    Payload payload;
+};
+#pragma pack(pop)
+
+/**
+ * @brief Growable byte buffer with the TEMP_BUFFER interface, safe off the game thread
+ *
+ * @details TEMP_BUFFER takes its memory from the libthecore buffer pool, which has no
+ * locking; a builder used by the ranking worker writes here instead.
+ */
+class PacketBuffer
+{
+public:
+    void write(const void* p_data, const int size)
+    {
+        const auto* const p_bytes{static_cast<const uint8_t*>(p_data)};
+        m_buffer.insert(m_buffer.end(), p_bytes, p_bytes + size);
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        if constexpr (requires { value.data(); value.size(); })
+        {
+            write(value.data(), static_cast<int>(value.size() * sizeof(*value.data())));
+        }
+        else
+        {
+            write(&value, static_cast<int>(sizeof(T)));
+        }
+    }
+
+    [[nodiscard]] const void* read_peek() const noexcept { return m_buffer.data(); }
+
+    [[nodiscard]] int size() const noexcept { return static_cast<int>(m_buffer.size()); }
+
+    /**
+     * @brief Forget the written bytes, keeping the capacity for the next packet
+     */
+    void reset() noexcept { m_buffer.clear(); }
+
+private:
+    std::vector<uint8_t> m_buffer{};
+};
+
 template <typename T>
 concept HeaderPacketConcept = requires(T t) {
     {
@@ -22,7 +80,7 @@ concept HeaderPacketConcept = requires(T t) {
     } -> std::convertible_to<uint8_t>;
 };
 
-template <typename HeaderPacket = DynamicPacketInfo>
+template <typename HeaderPacket = DynamicPacketInfo, typename Buffer = TEMP_BUFFER>
     requires HeaderPacketConcept<HeaderPacket>
 class DynamicPacketBuilder
 {
@@ -56,6 +114,21 @@ public:
         clear_buffer();
     }
 
+    /**
+     * @brief Move the written packets into an immutable buffer that can be sent to many clients
+     *
+     * @return shared_packet_t The serialized packets
+     */
+    shared_packet_t build()
+    {
+        const auto* const p_data{static_cast<const uint8_t*>(m_buffer.read_peek())};
+        auto packet{std::make_shared<const std::vector<uint8_t>>(p_data, p_data + m_buffer.size())};
+
+        clear_buffer();
+
+        return packet;
+    }
+
     void clear_buffer()
     {
         m_buffer.reset();
@@ -64,9 +137,39 @@ public:
 private:
     HeaderPacket m_header_packet{};
 
-    TEMP_BUFFER m_buffer;
+    Buffer m_buffer;
 };
 
+/**
+ * @brief Builder of shared packets, usable on any thread
+ */
+using shared_packet_builder_t = DynamicPacketBuilder<DynamicPacketInfo, PacketBuffer>;
+
+/**
+ * @brief Send a shared packet followed by a small per-recipient packet
+ *
+ * @param p_character The recipient
+ * @param shared_packet The packet serialized once for every recipient
+ * @param suffix_packet The packet serialized for this recipient only
+ *
+ * @details The shared bytes are only queued on the descriptor and go out
+ * together with the suffix, so nothing is encoded again per recipient.
+ */
+template <typename Payload, typename HeaderPacket>
+void send_to_client(const LPCHARACTER p_character, const shared_packet_t& shared_packet,
+                    const DynamicPacket<Payload, HeaderPacket>& suffix_packet)
+{
+    const auto p_desc{p_character->GetDesc()};
+
+    if (nullptr == p_desc)
+    {
+        return;
+    }
+
+    p_desc->BufferedPacket(shared_packet->data(), static_cast<int>(shared_packet->size()));
+    p_desc->Packet(&suffix_packet, sizeof(suffix_packet));
+}
+
 } // namespace networkutils
 
 #endif // NETWORKUTILS_HPP
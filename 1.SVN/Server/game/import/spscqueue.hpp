@@ -0,0 +1,130 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <vector>
+
+namespace threadutils
+{
+
+/**
+ * @brief Bounded lock-free queue between exactly one producer thread and one consumer thread
+ *
+ * @details A power-of-two ring of preallocated slots. The producer only writes the tail and the
+ * consumer only writes the head, each on its own cache line, and each side keeps a cached copy
+ * of the other side's index so the shared line is only read when the ring looks full or empty.
+ * Elements are moved in and out, so a slot keeps no resources once popped.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    /**
+     * @brief Construct a new SpscQueue object
+     *
+     * @param capacity The number of slots, rounded up to a power of two
+     */
+    explicit SpscQueue(const size_t capacity)
+    {
+        size_t ring_size{1U};
+
+        while (ring_size < capacity)
+        {
+            ring_size <<= 1U;
+        }
+
+        m_slot_vec.resize(ring_size);
+        m_mask = ring_size - 1U;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Append an element, producer thread only
+     *
+     * @param value The element
+     * @return bool False if the ring is full; the element is left untouched
+     */
+    [[nodiscard]] bool try_push(T& value)
+    {
+        const auto tail{m_tail.load(std::memory_order_relaxed)};
+
+        if (tail - m_cached_head > m_mask)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+
+            if (tail - m_cached_head > m_mask) { return false; }
+        }
+
+        m_slot_vec[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1U, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest element, consumer thread only
+     *
+     * @param value Receives the element
+     * @return bool False if the ring is empty
+     */
+    [[nodiscard]] bool try_pop(T& value)
+    {
+        const auto head{m_head.load(std::memory_order_relaxed)};
+
+        if (head == m_cached_tail)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+
+            if (head == m_cached_tail) { return false; }
+        }
+
+        value = std::move(m_slot_vec[head & m_mask]);
+        m_head.store(head + 1U, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Get the number of slots
+     */
+    [[nodiscard]] size_t get_capacity() const noexcept
+    {
+        return m_slot_vec.size();
+    }
+
+private:
+    static constexpr size_t cache_line_size{64U};
+
+    std::vector<T> m_slot_vec{};
+    size_t m_mask{};
+
+    /**
+     * @brief Next slot to pop, written by the consumer
+     */
+    alignas(cache_line_size) std::atomic<size_t> m_head{};
+
+    /**
+     * @brief Consumer's copy of m_tail
+     */
+    size_t m_cached_tail{};
+
+    /**
+     * @brief Next slot to push, written by the producer
+     */
+    alignas(cache_line_size) std::atomic<size_t> m_tail{};
+
+    /**
+     * @brief Producer's copy of m_head
+     */
+    size_t m_cached_head{};
+};
+
+} // namespace threadutils
+
+#endif // SPSCQUEUE_HPP
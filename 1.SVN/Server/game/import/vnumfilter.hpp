@@ -0,0 +1,103 @@
+/*
+ * ? Author: LWT
+ */
+
+#ifndef VNUMFILTER_HPP
+#define VNUMFILTER_HPP
+
+namespace hashutils
+{
+
+/**
+ * @brief Membership filter over mob vnums
+ *
+ * @details Vnums below dense_limit are kept in a bitmap sized to the highest
+ * one inserted, so a lookup is one bounds check, one load and one bit test.
+ * The rare vnums above the limit fall back to a hash set, which is only
+ * probed when it is not empty. The filter is built once and then swapped in
+ * whole, so readers never see a half-filled bitmap.
+ */
+class VnumFilter
+{
+public:
+    /**
+     * @brief Vnums below this limit live in the bitmap (16 KiB at most)
+     */
+    static constexpr uint32_t dense_limit{1U << 17};
+
+    /**
+     * @brief Check if a vnum was inserted
+     *
+     * @param vnum The mob vnum
+     * @return bool
+     */
+    [[nodiscard]] bool contains(const uint32_t vnum) const noexcept
+    {
+        if (vnum < dense_limit)
+        {
+            const auto word_index{vnum >> word_shift};
+
+            return word_index < m_words.size() && 0U != ((m_words[word_index] >> (vnum & word_mask)) & 1U);
+        }
+
+        if (m_sparse_vnums.empty())
+        {
+            return false;
+        }
+
+#if __cplusplus >= 202002L
+        return m_sparse_vnums.contains(vnum);
+#else
+        return 0U != m_sparse_vnums.count(vnum);
+#endif
+    }
+
+    /**
+     * @brief Insert a vnum
+     *
+     * @param vnum The mob vnum
+     */
+    void insert(const uint32_t vnum)
+    {
+        if (vnum >= dense_limit)
+        {
+            m_sparse_vnums.emplace(vnum);
+            return;
+        }
+
+        const auto word_index{vnum >> word_shift};
+
+        if (word_index >= m_words.size())
+        {
+            m_words.resize(word_index + 1U);
+        }
+
+        m_words[word_index] |= uint64_t{1} << (vnum & word_mask);
+    }
+
+    /**
+     * @brief Check if no vnum was inserted
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_words.empty() && m_sparse_vnums.empty();
+    }
+
+private:
+    static constexpr uint32_t word_shift{6U};
+    static constexpr uint32_t word_mask{63U};
+
+    /**
+     * @brief Bitmap of the vnums below dense_limit
+     */
+    std::vector<uint64_t> m_words{};
+
+    /**
+     * @brief Vnums at or above dense_limit
+     */
+    std::unordered_set<uint32_t> m_sparse_vnums{};
+};
+
+} // namespace hashutils
+
+#endif // VNUMFILTER_HPP
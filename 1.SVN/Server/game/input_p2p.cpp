@@ -15,7 +15,23 @@
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
 	    case HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING:
 	    {
-	        bossdamageranking::boss_dmg_ranking_manager().initialize();
+	        if ((iExtraLen = bossdamageranking::boss_dmg_ranking_manager().recv_p2p_packet(d, c_pData, m_iBufferLeft)) < 0)
+	            return -1;
 	        break;
 	    }
-#endif
\ No newline at end of file
+#endif
+
+// find
+
+void CInputP2P::Setup(LPDESC d, const char * c_pData)
+{
+	TPacketGGSetup * p = (TPacketGGSetup *) c_pData;
+	sys_log(0, "P2P: Setup %s:%d", d->GetHostName(), p->wPort);
+	d->SetP2P(d->GetHostName(), p->wPort, p->bChannel);
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+	// a peer that booted or reconnected compares its config with this core's
+	bossdamageranking::boss_dmg_ranking_manager().send_config_checksum(d);
+#endif
@@ -26,4 +26,14 @@
         {
                 boss_dmg_ranking_manager.initialize();
         }
+#endif
+
+// find
+
+	CHARACTER_MANAGER::instance().Update(pulse);
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+	bossdamageranking::boss_dmg_ranking_manager().update(pulse);
 #endif
\ No newline at end of file
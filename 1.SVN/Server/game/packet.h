@@ -36,6 +36,21 @@ enum class EPacketCGBossDamageRankingSubHeaderType : uint8_t
 {
     BOSS_DMG_RANKING_RANK_INFO,
     BOSS_DMG_RANKING_DAMAGE_INFO,
+    BOSS_DMG_RANKING_RANK_DELTA,
+    BOSS_DMG_RANKING_GROUP_INFO,
+};
+
+enum class EBossDamageRankingGroupType : uint8_t
+{
+    PARTY,
+    GUILD,
+};
+
+enum class EBossDamageRankingRowField : uint8_t
+{
+    PLAYER = 1 << 0,
+    PERCENT_DAMAGE = 1 << 1,
+    BAD_AFFECT_FLAG = 1 << 2,
 };
 
 struct SPacketCGBossDamageRanking
@@ -46,7 +61,26 @@ struct SPacketCGBossDamageRanking
 
 struct SPacketGCRankingGeneralInfo
 {
+    uint32_t boss_vid;
+    uint32_t version;
+    uint8_t rank_size;
+};
+
+struct SPacketGCRankingDeltaInfo
+{
+    uint32_t boss_vid;
+    uint32_t base_version;
+    uint32_t version;
     uint8_t rank_size;
+    uint8_t row_count;
+};
+
+// followed by race and name if PLAYER is set, percent_damage if PERCENT_DAMAGE is set
+// and bad_affect_flag if BAD_AFFECT_FLAG is set
+struct SPacketGCBossDamageRankingDeltaRow
+{
+    uint8_t position;
+    uint8_t field_mask;
 };
 
 struct SPacketGCBossDamageRankingInfo
@@ -56,4 +90,71 @@ struct SPacketGCBossDamageRankingInfo
     uint8_t percent_damage;
     uint8_t bad_affect_flag;
 };
+
+struct SPacketGCBossDamageRankingDamageInfo
+{
+    uint16_t rank;
+    uint16_t participant_count;
+    uint8_t percent_damage;
+    uint64_t damage;
+    // damage per second over the last 10 seconds, or since the first hit if that is sooner
+    uint32_t dps;
+};
+
+// followed by rank_size SPacketGCBossDamageRankingGroupInfo, highest damage first;
+// always sent with a full ranking, with a delta only if the group rows changed
+struct SPacketGCBossDamageRankingGroupGeneralInfo
+{
+    uint32_t boss_vid;
+    uint8_t group_type;
+    uint8_t rank_size;
+};
+
+// name is the guild name, or the party leader's name; a party whose leader is on another
+// core is named after the member that first brought it into the ranking
+struct SPacketGCBossDamageRankingGroupInfo
+{
+    char name[CHARACTER_NAME_MAX_LEN + 1];
+    uint16_t member_count;
+    uint8_t percent_damage;
+};
+
+enum class EPacketGGBossDamageRankingSubHeaderType : uint8_t
+{
+    BOSS_DMG_RANKING_CONFIG,
+    BOSS_DMG_RANKING_RESYNC_REQUEST,
+    BOSS_DMG_RANKING_RESYNC_CONFIG,
+    BOSS_DMG_RANKING_CHECKSUM,
+};
+
+// followed by boss_count SPacketGGBossDamageRankingBossSettings, size bytes in total;
+// checksum is the FNV-1a hash of those bytes, loaded_at orders two snapshots.
+// A CHECKSUM announcement carries no rows: size is 0, checksum and boss_count describe the sender's snapshot
+struct SPacketGGBossDamageRankingConfig
+{
+    uint8_t header;
+    uint8_t sub_header;
+    uint32_t size;
+    uint32_t checksum;
+    uint32_t boss_count;
+    uint32_t loaded_at;
+};
+
+enum class EBossDamageRankingSettingsFlag : uint8_t
+{
+    HAS_TOP_LIMIT = 1 << 0,
+    HAS_BROADCAST_INTERVAL = 1 << 1,
+    TRACK_DOT_FLAGS = 1 << 2,
+    PERSIST_RESULT = 1 << 3,
+};
+
+// top_limit and broadcast_interval are only meaningful if their HAS_ flag is set
+struct SPacketGGBossDamageRankingBossSettings
+{
+    uint32_t mob_vnum;
+    uint8_t top_limit;
+    uint32_t broadcast_interval;
+    uint32_t max_participants;
+    uint8_t flags;
+};
 #endif
@@ -5,5 +5,5 @@
 // add below
 
 #ifdef BOSS_DAMAGE_RANKING_PLUGIN
-        Set(HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING,		sizeof(uint8_t),	"BossDamageRanking",		false);
+        Set(HEADER_GG_UPDATE_BOSS_DAMAGE_RANKING,		sizeof(SPacketGGBossDamageRankingConfig),	"BossDamageRanking",		false);
 #endif
\ No newline at end of file
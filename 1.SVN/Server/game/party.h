@@ -0,0 +1,22 @@
+// find
+
+class CParty
+{
+  public:
+
+// add below
+
+#ifdef BOSS_DAMAGE_RANKING_PLUGIN
+    // the party's row in the boss damage rankings: unlike the leader PID it survives a
+    // leader change, and it is never reused while the core runs
+    uint32_t GetBossDamageRankingPartyID() const
+    {
+        return m_bossDamageRankingPartyID;
+    }
+
+  private:
+    inline static uint32_t ms_bossDamageRankingPartyCount{};
+    const uint32_t m_bossDamageRankingPartyID{++ms_bossDamageRankingPartyCount};
+
+  public:
+#endif
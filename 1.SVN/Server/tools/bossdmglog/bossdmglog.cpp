@@ -0,0 +1,312 @@
+/*
+ * ? Author: LWT
+ * * Description: Offline reader of the boss damage ranking event logs.
+ *
+ * Reads the .bdrl files the cores write on boss kills when
+ * boss_dmg_ranking_event_log_dir is set, and prints per-player DPS curves
+ * as CSV (player_id,name,second,damage,dps), one row per player and bucket,
+ * or a per-player summary of the fight.
+ *
+ *   ./bossdmglog [-b bucket_ms] [-t top] file.bdrl     DPS curves
+ *   ./bossdmglog -s [-t top] file.bdrl...              fight summaries
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "bossdamagerankingeventlog.hpp"
+
+using namespace bossdamageranking;
+
+namespace
+{
+
+/**
+ * @brief Content of one event log file
+ */
+struct EventLogFile
+{
+    BossDamageRankingLogHeader header{};
+    std::vector<BossDamageRankingLogParticipant> participant_vec{};
+    std::vector<BossDamageRankingLogEvent> event_vec{};
+};
+
+/**
+ * @brief Read and check an event log file
+ *
+ * @param p_path The file
+ * @param file Receives the content
+ * @return bool False, with a message on stderr, if the file is not a valid event log
+ */
+bool read_event_log(const char* p_path, EventLogFile& file)
+{
+    auto* const p_file{std::fopen(p_path, "rb")};
+
+    if (nullptr == p_file)
+    {
+        std::fprintf(stderr, "%s: cannot open\n", p_path);
+        return false;
+    }
+
+    auto& header{file.header};
+    bool is_valid{1U == std::fread(&header, sizeof(header), 1U, p_file) &&
+                  0 == std::memcmp(header.magic, event_log_magic, sizeof(header.magic))};
+
+    if (is_valid && event_log_version != header.version)
+    {
+        std::fprintf(stderr, "%s: unsupported version %u\n", p_path, static_cast<uint32_t>(header.version));
+        std::fclose(p_file);
+        return false;
+    }
+
+    if (is_valid)
+    {
+        file.participant_vec.resize(header.participant_count);
+        file.event_vec.resize(header.event_count);
+
+        is_valid = file.participant_vec.size() ==
+                       std::fread(file.participant_vec.data(), sizeof(BossDamageRankingLogParticipant),
+                           file.participant_vec.size(), p_file) &&
+                   file.event_vec.size() ==
+                       std::fread(file.event_vec.data(), sizeof(BossDamageRankingLogEvent), file.event_vec.size(), p_file);
+    }
+
+    std::fclose(p_file);
+
+    if (!is_valid)
+    {
+        std::fprintf(stderr, "%s: not a boss damage ranking event log\n", p_path);
+        return false;
+    }
+
+    // a slot outside the participant table would index out of bounds below
+    const auto bad_event_iter{std::find_if(file.event_vec.begin(),
+        file.event_vec.end(),
+        [&header](const BossDamageRankingLogEvent& event) { return event.player_slot >= header.participant_count; })};
+
+    if (file.event_vec.end() != bad_event_iter)
+    {
+        std::fprintf(stderr, "%s: event with an unknown participant slot %u\n", p_path, bad_event_iter->player_slot);
+        return false;
+    }
+
+    // the curves are sized from the first and last event, a timestamp going back would index out of bounds
+    const auto unordered_event_iter{std::adjacent_find(file.event_vec.begin(),
+        file.event_vec.end(),
+        [](const BossDamageRankingLogEvent& lhs, const BossDamageRankingLogEvent& rhs)
+        { return lhs.relative_ms > rhs.relative_ms; })};
+
+    if (file.event_vec.end() != unordered_event_iter)
+    {
+        std::fprintf(stderr, "%s: event timestamp going back from %u ms\n", p_path, unordered_event_iter->relative_ms);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the participant slots ordered by total damage, highest first
+ *
+ * @param file The event log
+ * @param top The most slots returned, 0 for all
+ */
+std::vector<uint32_t> get_ranked_slots(const EventLogFile& file, const size_t top)
+{
+    std::vector<uint32_t> slot_vec(file.participant_vec.size());
+    std::iota(slot_vec.begin(), slot_vec.end(), 0U);
+
+    std::stable_sort(slot_vec.begin(),
+        slot_vec.end(),
+        [&file](const uint32_t lhs, const uint32_t rhs)
+        { return file.participant_vec[lhs].damage > file.participant_vec[rhs].damage; });
+
+    if (0U != top && slot_vec.size() > top)
+    {
+        slot_vec.resize(top);
+    }
+
+    return slot_vec;
+}
+
+/**
+ * @brief Print the DPS curve of the ranked participants as CSV rows
+ *
+ * @param file The event log
+ * @param bucket_ms The width of a curve point in milliseconds
+ * @param top The most participants printed, 0 for all
+ */
+void print_dps_curves(const EventLogFile& file, const uint32_t bucket_ms, const size_t top)
+{
+    if (file.event_vec.empty())
+    {
+        return;
+    }
+
+    // a wrapped ring lost the start of the fight, so the curve starts at the oldest event
+    const auto first_bucket{file.event_vec.front().relative_ms / bucket_ms};
+    const auto bucket_count{static_cast<size_t>(file.event_vec.back().relative_ms / bucket_ms - first_bucket) + 1U};
+
+    // damage per participant slot and bucket, one row of buckets per slot
+    std::vector<uint64_t> damage_vec(file.participant_vec.size() * bucket_count);
+
+    for (const auto& event: file.event_vec)
+    {
+        damage_vec[event.player_slot * bucket_count + event.relative_ms / bucket_ms - first_bucket] += event.damage;
+    }
+
+    const auto bucket_sec{static_cast<double>(bucket_ms) / 1000.0};
+
+    std::printf("player_id,name,second,damage,dps\n");
+
+    for (const auto player_slot: get_ranked_slots(file, top))
+    {
+        const auto& participant{file.participant_vec[player_slot]};
+
+        for (size_t bucket{}; bucket < bucket_count; ++bucket)
+        {
+            const auto damage{damage_vec[player_slot * bucket_count + bucket]};
+
+            std::printf("%u,%.*s,%.3f,%llu,%.1f\n",
+                participant.player_id,
+                static_cast<int>(sizeof(participant.player_name)),
+                participant.player_name,
+                static_cast<double>(first_bucket + bucket) * bucket_sec,
+                static_cast<unsigned long long>(damage),
+                static_cast<double>(damage) / bucket_sec);
+        }
+    }
+}
+
+/**
+ * @brief Print the fight and the average and peak DPS of the ranked participants
+ *
+ * @param p_path The file name
+ * @param file The event log
+ * @param top The most participants printed, 0 for all
+ */
+void print_summary(const char* p_path, const EventLogFile& file, const size_t top)
+{
+    const auto& header{file.header};
+
+    std::printf("%s: boss %u (vid %u) on map %d, %.1f s, %u participants, %u events, %llu dropped\n",
+        p_path,
+        header.mob_vnum,
+        header.mob_vid,
+        header.map_index,
+        static_cast<double>(header.duration_ms) / 1000.0,
+        header.participant_count,
+        header.event_count,
+        static_cast<unsigned long long>(header.dropped_event_count));
+
+    if (file.event_vec.empty())
+    {
+        return;
+    }
+
+    // only the recorded part of the fight, so a wrapped ring does not dilute the averages
+    const auto first_ms{file.event_vec.front().relative_ms};
+    const auto recorded_sec{std::max(static_cast<double>(file.event_vec.back().relative_ms - first_ms) / 1000.0, 1.0)};
+    const auto second_count{static_cast<size_t>(recorded_sec) + 1U};
+
+    std::vector<uint64_t> damage_vec(file.participant_vec.size() * second_count);
+    std::vector<uint64_t> recorded_damage_vec(file.participant_vec.size());
+
+    for (const auto& event: file.event_vec)
+    {
+        damage_vec[event.player_slot * second_count + (event.relative_ms - first_ms) / 1000U] += event.damage;
+        recorded_damage_vec[event.player_slot] += event.damage;
+    }
+
+    std::printf("  %4s %10s %-24s %14s %10s %10s\n", "rank", "player_id", "name", "damage", "avg_dps", "peak_dps");
+
+    size_t rank{};
+
+    for (const auto player_slot: get_ranked_slots(file, top))
+    {
+        const auto& participant{file.participant_vec[player_slot]};
+        const auto* const p_first_second{damage_vec.data() + player_slot * second_count};
+
+        std::printf("  %4zu %10u %-24.*s %14llu %10.1f %10llu\n",
+            ++rank,
+            participant.player_id,
+            static_cast<int>(sizeof(participant.player_name)),
+            participant.player_name,
+            static_cast<unsigned long long>(participant.damage),
+            static_cast<double>(recorded_damage_vec[player_slot]) / recorded_sec,
+            static_cast<unsigned long long>(*std::max_element(p_first_second, p_first_second + second_count)));
+    }
+}
+
+void print_usage(const char* p_program)
+{
+    std::fprintf(stderr,
+        "usage: %s [-b bucket_ms] [-t top] file.bdrl\n"
+        "       %s -s [-t top] file.bdrl...\n",
+        p_program,
+        p_program);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    uint32_t bucket_ms{1000U};
+    size_t top{};
+    bool is_summary{};
+    int arg_index{1};
+
+    for (; arg_index < argc && '-' == argv[arg_index][0]; ++arg_index)
+    {
+        if (0 == std::strcmp(argv[arg_index], "-s"))
+        {
+            is_summary = true;
+        }
+        else if (0 == std::strcmp(argv[arg_index], "-b") && arg_index + 1 < argc)
+        {
+            bucket_ms = static_cast<uint32_t>(std::strtoul(argv[++arg_index], nullptr, 10));
+        }
+        else if (0 == std::strcmp(argv[arg_index], "-t") && arg_index + 1 < argc)
+        {
+            top = static_cast<size_t>(std::strtoul(argv[++arg_index], nullptr, 10));
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (arg_index >= argc || 0U == bucket_ms || (!is_summary && arg_index + 1 != argc))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int exit_code{EXIT_SUCCESS};
+
+    for (; arg_index < argc; ++arg_index)
+    {
+        EventLogFile file{};
+
+        if (!read_event_log(argv[arg_index], file))
+        {
+            exit_code = EXIT_FAILURE;
+            continue;
+        }
+
+        if (is_summary)
+        {
+            print_summary(argv[arg_index], file, top);
+        }
+        else
+        {
+            print_dps_curves(file, bucket_ms, top);
+        }
+    }
+
+    return exit_code;
+}
@@ -15,9 +15,31 @@ class PlayerInfo(object):
         self.bad_affect_flag = bad_affect_flag
 
 
+class GroupInfo(object):
+    def __init__(self, name, member_count, percent_damage):
+        self.name = name
+        self.member_count = member_count
+        self.percent_damage = percent_damage
+
+
+class OwnDamageInfo(object):
+    def __init__(self, rank, participant_count, percent_damage, damage, dps):
+        self.rank = rank
+        self.participant_count = participant_count
+        self.percent_damage = percent_damage
+        self.damage = damage
+        self.dps = dps
+
+
 class PlayerRankingManager(object):
+    # group types as sent by the server, party first
+    GROUP_PARTY = 0
+    GROUP_GUILD = 1
+
     def __init__(self):
         self.player_info_list = []
+        self.group_info_lists = {self.GROUP_PARTY: [], self.GROUP_GUILD: []}
+        self.own_damage_info = None
 
     def update_player_info(self, new_player_info):
         """
@@ -26,10 +48,29 @@ class PlayerRankingManager(object):
         """
         self.player_info_list = [PlayerInfo(*info) for info in new_player_info]
 
+    def update_damage_info(self, new_damage_info):
+        """
+        Update the receiver's own ranking row.
+        :param new_damage_info: List [rank, participant_count, percent_damage, damage, dps]
+        """
+        self.own_damage_info = OwnDamageInfo(*new_damage_info)
+
+    def update_group_info(self, group_type, new_group_info):
+        """
+        Update the ranking of one group type.
+        :param group_type: GROUP_PARTY or GROUP_GUILD
+        :param new_group_info: List of lists [[name, member_count, percent_damage], ...]
+        """
+        self.group_info_lists[group_type] = [GroupInfo(*info) for info in new_group_info]
+
 
 class BossDamageRankingUI(object):
+    Y_INC_POS = 22
+
     def __init__(self):
         self.wnd_dict = {}
+        self.own_wnd_dict = {}
+        self.view_button = None
 
     def create_dialog(self, parent, player_info_list):
         """
@@ -81,16 +122,107 @@ class BossDamageRankingUI(object):
         parent.SetPosition(wndMgr.GetScreenWidth() - 330, 310)
         # parent.Show()
 
+    def create_group_dialog(self, parent, group_info_list):
+        """
+        Create the UI elements for a party or guild ranking display.
+        :param parent: Parent UI element
+        :param group_info_list: List of GroupInfo objects
+        """
+        self.wnd_dict.clear()
+
+        for idx, group_info in enumerate(group_info_list):
+            height_inc = self.Y_INC_POS * idx
+
+            group_name_text = ui.TextLine()
+            group_name_text.SetParent(parent)
+            group_name_text.SetPosition(10, 10 + height_inc)
+            group_name_text.SetHorizontalAlignLeft()
+            group_name_text.SetText("{0} ({1})".format(group_info.name, group_info.member_count))
+            group_name_text.Hide()
+            self.wnd_dict["group_name_text{0}".format(idx)] = group_name_text
+
+            group_percent_dmg_text = ui.TextLine()
+            group_percent_dmg_text.SetParent(parent)
+            group_percent_dmg_text.SetPosition(170, 10 + height_inc)
+            group_percent_dmg_text.SetHorizontalAlignLeft()
+            group_percent_dmg_text.SetText("%{}".format(group_info.percent_damage))
+            group_percent_dmg_text.Hide()
+            self.wnd_dict["group_percent_dmg_text{0}".format(idx)] = group_percent_dmg_text
+
+            group_damage_gauge = ui.Gauge()
+            group_damage_gauge.SetParent(parent)
+            group_damage_gauge.SetPosition(205, 12 + height_inc)
+            group_damage_gauge.MakeGauge(100, "red")
+            group_damage_gauge.SetPercentage(group_info.percent_damage, 100)
+            group_damage_gauge.Hide()
+            self.wnd_dict["group_damage_gauge{0}".format(idx)] = group_damage_gauge
+
+        parent.SetSize(320, len(group_info_list) * 25)
+        parent.SetPosition(wndMgr.GetScreenWidth() - 330, 310)
+
+    def create_view_button(self, parent, view_name, event):
+        """
+        Create or relabel the button that switches between the player, party and guild rankings.
+        :param parent: Parent UI element
+        :param view_name: Name of the ranking shown
+        :param event: Called when the button is clicked
+        """
+        if self.view_button is None:
+            self.view_button = ui.Button()
+            self.view_button.SetParent(parent)
+            self.view_button.SetUpVisual("d:/ymir work/ui/public/small_button_01.sub")
+            self.view_button.SetOverVisual("d:/ymir work/ui/public/small_button_02.sub")
+            self.view_button.SetDownVisual("d:/ymir work/ui/public/small_button_03.sub")
+            self.view_button.SetPosition(265, -20)
+            self.view_button.SetEvent(event)
+            self.view_button.Show()
+
+        self.view_button.SetText(view_name)
+
+    def create_own_row(self, parent, row_count, own_damage_info):
+        """
+        Create or move the receiver's own ranking row below the top rows.
+        :param parent: Parent UI element
+        :param row_count: Number of top rows shown above
+        :param own_damage_info: OwnDamageInfo object
+        """
+        if not self.own_wnd_dict:
+            for key, x_pos in (("own_rank_text", 10), ("own_percent_dmg_text", 170), ("own_damage_text", 205)):
+                text_line = ui.TextLine()
+                text_line.SetParent(parent)
+                text_line.SetHorizontalAlignLeft()
+                self.own_wnd_dict[key] = (text_line, x_pos)
+
+        y_pos = 10 + self.Y_INC_POS * row_count
+        for text_line, x_pos in self.own_wnd_dict.values():
+            text_line.SetPosition(x_pos, y_pos)
+            text_line.Show()
+
+        self.own_wnd_dict["own_rank_text"][0].SetText(
+            "#{0}/{1}".format(own_damage_info.rank, own_damage_info.participant_count))
+        self.own_wnd_dict["own_percent_dmg_text"][0].SetText("%{}".format(own_damage_info.percent_damage))
+        self.own_wnd_dict["own_damage_text"][0].SetText(
+            "{:,} ({:,}/s)".format(own_damage_info.damage, own_damage_info.dps))
+
+        parent.SetSize(320, (row_count + 1) * 25)
+
     def update_dialog(self):
         map(lambda wnd: wnd.Show(), self.wnd_dict.values())
 
 
 class BossDamageRanking(ui.ThinBoard):
+    VIEW_PLAYERS = 0
+    VIEW_PARTY = 1
+    VIEW_GUILD = 2
+
+    VIEW_NAMES = {VIEW_PLAYERS: "Player", VIEW_PARTY: "Party", VIEW_GUILD: "Guild"}
+
     def __init__(self):
         super(BossDamageRanking, self).__init__()
         boss_damage_ranking.set_ui_window(self)
         self.manager = PlayerRankingManager()
         self.ui = BossDamageRankingUI()
+        self.view = self.VIEW_PLAYERS
 
     def __del__(self):
         super(BossDamageRanking, self).__del__()
@@ -110,6 +242,64 @@ class BossDamageRanking(ui.ThinBoard):
         """
 
         self.manager.update_player_info(player_info_list)
-        self.ui.create_dialog(self, self.manager.player_info_list)
-        self.ui.update_dialog()
+
+        if self.view == self.VIEW_PLAYERS:
+            self.refresh_view()
+
         self.open()
+
+    def update_group_ranking_info(self, group_ranking_info):
+        """
+        Update a party or guild ranking, sent right after the top rows.
+        :param group_ranking_info: List [group_type, [[name, member_count, percent_damage], ...]]
+        """
+
+        group_type, group_info_list = group_ranking_info
+        self.manager.update_group_info(group_type, group_info_list)
+
+        if self.view == self.__get_group_view(group_type):
+            self.refresh_view()
+
+    def toggle_view(self):
+        """
+        Switch to the next ranking: players, then parties, then guilds.
+        """
+
+        self.view = (self.view + 1) % len(self.VIEW_NAMES)
+        self.refresh_view()
+
+    def refresh_view(self):
+        if self.view == self.VIEW_PLAYERS:
+            row_count = len(self.manager.player_info_list)
+            self.ui.create_dialog(self, self.manager.player_info_list)
+        else:
+            group_info_list = self.manager.group_info_lists[self.__get_group_type(self.view)]
+            row_count = len(group_info_list)
+            self.ui.create_group_dialog(self, group_info_list)
+
+        self.ui.create_view_button(self, self.VIEW_NAMES[self.view], self.toggle_view)
+        self.ui.update_dialog()
+
+        if self.manager.own_damage_info is not None:
+            self.ui.create_own_row(self, row_count, self.manager.own_damage_info)
+
+    def __get_group_view(self, group_type):
+        return self.VIEW_PARTY if group_type == PlayerRankingManager.GROUP_PARTY else self.VIEW_GUILD
+
+    def __get_group_type(self, view):
+        return PlayerRankingManager.GROUP_PARTY if view == self.VIEW_PARTY else PlayerRankingManager.GROUP_GUILD
+
+    def update_damage_info(self, damage_info):
+        """
+        Update the receiver's own ranking row, sent right after the top rows.
+        :param damage_info: List [rank, participant_count, percent_damage, damage, dps]
+        """
+
+        self.manager.update_damage_info(damage_info)
+
+        if self.view == self.VIEW_PLAYERS:
+            row_count = len(self.manager.player_info_list)
+        else:
+            row_count = len(self.manager.group_info_lists[self.__get_group_type(self.view)])
+
+        self.ui.create_own_row(self, row_count, self.manager.own_damage_info)
@@ -7,6 +7,11 @@ SET FOREIGN_KEY_CHECKS = 0;
 DROP TABLE IF EXISTS `boss_dmg_ranking`;
 CREATE TABLE `boss_dmg_ranking`  (
   `boss_vnum` int UNSIGNED NOT NULL DEFAULT 0,
+  `top_n` tinyint UNSIGNED NULL DEFAULT NULL COMMENT 'NULL uses boss_dmg_ranking_top_limit of the core',
+  `broadcast_interval_ms` int UNSIGNED NULL DEFAULT NULL COMMENT 'NULL uses boss_dmg_ranking_broadcast_interval of the core',
+  `max_participants` int UNSIGNED NOT NULL DEFAULT 0 COMMENT '0 for no limit',
+  `track_dot_flags` tinyint UNSIGNED NOT NULL DEFAULT 1,
+  `persist_result` tinyint UNSIGNED NOT NULL DEFAULT 1,
   PRIMARY KEY (`boss_vnum`) USING BTREE
 ) ENGINE = InnoDB CHARACTER SET = latin1 COLLATE = latin1_swedish_ci ROW_FORMAT = Dynamic;
 
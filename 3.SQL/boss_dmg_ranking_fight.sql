@@ -0,0 +1,39 @@
+SET NAMES utf8mb4;
+SET FOREIGN_KEY_CHECKS = 0;
+
+-- ----------------------------
+-- Table structure for boss_dmg_ranking_fight
+-- ----------------------------
+DROP TABLE IF EXISTS `boss_dmg_ranking_fight`;
+CREATE TABLE `boss_dmg_ranking_fight`  (
+  `channel` tinyint UNSIGNED NOT NULL DEFAULT 0,
+  `map_index` int NOT NULL DEFAULT 0,
+  `boss_vid` int UNSIGNED NOT NULL DEFAULT 0,
+  `spawn_time` int UNSIGNED NOT NULL DEFAULT 0,
+  `boss_vnum` int UNSIGNED NOT NULL DEFAULT 0,
+  `end_time` int UNSIGNED NOT NULL DEFAULT 0,
+  `end_reason` tinyint UNSIGNED NOT NULL DEFAULT 0 COMMENT '0 killed, 1 despawned, 2 map closed, 3 unranked, 4 reaped',
+  `max_hp` bigint UNSIGNED NOT NULL DEFAULT 0,
+  `participant_count` int UNSIGNED NOT NULL DEFAULT 0,
+  PRIMARY KEY (`channel`, `map_index`, `boss_vid`, `spawn_time`) USING BTREE,
+  INDEX `boss_vnum_end_time`(`boss_vnum`, `end_time`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = latin1 COLLATE = latin1_swedish_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for boss_dmg_ranking_fight_participant
+-- ----------------------------
+DROP TABLE IF EXISTS `boss_dmg_ranking_fight_participant`;
+CREATE TABLE `boss_dmg_ranking_fight_participant`  (
+  `channel` tinyint UNSIGNED NOT NULL DEFAULT 0,
+  `map_index` int NOT NULL DEFAULT 0,
+  `boss_vid` int UNSIGNED NOT NULL DEFAULT 0,
+  `spawn_time` int UNSIGNED NOT NULL DEFAULT 0,
+  `player_id` int UNSIGNED NOT NULL DEFAULT 0,
+  `damage` bigint UNSIGNED NOT NULL DEFAULT 0,
+  `percent_damage` tinyint UNSIGNED NOT NULL DEFAULT 0,
+  `bad_affect_flag` tinyint UNSIGNED NOT NULL DEFAULT 0,
+  PRIMARY KEY (`channel`, `map_index`, `boss_vid`, `spawn_time`, `player_id`) USING BTREE,
+  INDEX `player_id`(`player_id`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = latin1 COLLATE = latin1_swedish_ci ROW_FORMAT = Dynamic;
+
+SET FOREIGN_KEY_CHECKS = 1;